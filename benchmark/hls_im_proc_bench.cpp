@@ -0,0 +1,430 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// throughput of every HlsImProc stage in C simulation
+//
+//   hls_im_proc_bench [--json FILE] [--repeat N] [--image PNG] [--sizes WxH,WxH,...]
+//
+// each stage runs on the output of the previous one over a frame sized array, and
+// its time is the median of N runs (after one warm-up run). Frames are synthetic (gradient, rings and noise)
+// and, when --image is given, the PNG image tiled to the frame size.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <hls_stream.h>
+
+#include "../src/HlsImProc.hpp"
+#include "../src/HostCannyEngine.hpp"
+
+#ifdef HLSIMPROC_BENCH_PNG
+#include <png.h>
+#endif
+
+using hlsimproc::HlsImProc;
+using hlsimproc::GradPix;
+using hlsimproc::ImAxis;
+
+// buffers sized for the largest frame (frame size is set at run time)
+#define BENCH_MAX_WIDTH  3840
+#define BENCH_MAX_HEIGHT 2160
+
+namespace {
+    const uint8_t BENCH_HTHR = 80;
+    const uint8_t BENCH_LTHR = 20;
+    const uint32_t PADDING_SIZE = 5;
+
+    struct FrameSize {
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct StageResult {
+        std::string name;
+        double ns_per_pixel;
+    };
+
+    struct HostResult {
+        uint32_t threads;
+        double ns_per_pixel;
+    };
+
+    struct Result {
+        std::string frame;
+        FrameSize size;
+        std::vector<StageResult> stages;
+        double pipeline_ns_per_pixel; // sum of the stages
+        double fused_ns_per_pixel;    // AXIS2GrayArray -> CannyFused -> GrayArray2AXIS
+        std::vector<HostResult> hosts; // HostCannyEngine for each --threads
+    };
+
+    // 24bit pixels in raster order (B in bits 7..0, R in bits 23..16)
+    std::vector<uint32_t> SyntheticFrame(FrameSize size) {
+        std::vector<uint32_t> frame(size_t(size.width) * size.height);
+        uint32_t seed = 12345;
+        for(uint32_t yi = 0; yi < size.height; yi++) {
+            for(uint32_t xi = 0; xi < size.width; xi++) {
+                seed = seed * 1103515245 + 12345;
+                const int dx = int(xi) - int(size.width / 2);
+                const int dy = int(yi) - int(size.height / 2);
+                const int ring = ((dx*dx + dy*dy) / 2048) % 2 ? 160 : 60;
+                const int ramp = int(xi * 64 / size.width);
+                const int noise = int((seed >> 16) % 16);
+                const uint32_t v = std::min(255, ring + ramp + noise);
+                frame[xi + size_t(yi)*size.width] = v | (v << 8) | (v << 16);
+            }
+        }
+        return frame;
+    }
+
+    // image tiled to the frame size
+    std::vector<uint32_t> TiledFrame(const std::vector<uint32_t>& image, FrameSize image_size, FrameSize size) {
+        std::vector<uint32_t> frame(size_t(size.width) * size.height);
+        for(uint32_t yi = 0; yi < size.height; yi++) {
+            for(uint32_t xi = 0; xi < size.width; xi++) {
+                frame[xi + size_t(yi)*size.width] =
+                    image[(xi % image_size.width) + size_t(yi % image_size.height)*image_size.width];
+            }
+        }
+        return frame;
+    }
+
+#ifdef HLSIMPROC_BENCH_PNG
+    bool LoadPng(const char* filename, std::vector<uint32_t>& image, FrameSize& size) {
+        png_image png = png_image();
+        png.version = PNG_IMAGE_VERSION;
+        if(!png_image_begin_read_from_file(&png, filename)) {
+            return false;
+        }
+        png.format = PNG_FORMAT_BGR;
+        std::vector<uint8_t> bgr(PNG_IMAGE_SIZE(png));
+        if(!png_image_finish_read(&png, NULL, bgr.data(), 0, NULL)) {
+            png_image_free(&png);
+            return false;
+        }
+        size.width  = png.width;
+        size.height = png.height;
+        image.resize(size_t(size.width) * size.height);
+        for(size_t i = 0; i < image.size(); i++) {
+            image[i] = bgr[3*i] | (bgr[3*i + 1] << 8) | (bgr[3*i + 2] << 16);
+        }
+        return true;
+    }
+#endif
+
+    void PushFrame(const std::vector<uint32_t>& frame, FrameSize size, hls::stream<ImAxis<24> >& axis_dst) {
+        ImAxis<24> axis_writer;
+        for(uint32_t yi = 0; yi < size.height; yi++) {
+            for(uint32_t xi = 0; xi < size.width; xi++) {
+                axis_writer.data = frame[xi + size_t(yi)*size.width];
+                axis_writer.user = (xi == 0 && yi == 0);
+                axis_writer.last = (xi == size.width - 1);
+                axis_dst << axis_writer;
+            }
+        }
+    }
+
+    void DrainFrame(hls::stream<ImAxis<24> >& axis_src) {
+        while(!axis_src.empty()) {
+            axis_src.read();
+        }
+    }
+
+    // median time of the runs of func in ns per pixel (prepare runs untimed before each,
+    // and one untimed run first touches the buffers)
+    template<typename PREPARE, typename FUNC>
+    double MedianNsPerPixel(int repeat, FrameSize size, PREPARE prepare, FUNC func) {
+        prepare();
+        func();
+
+        std::vector<double> times;
+        for(int r = 0; r < repeat; r++) {
+            prepare();
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            func();
+            const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        return times[times.size() / 2] / (double(size.width) * size.height);
+    }
+
+    void NoPrepare() {}
+
+    Result RunFrame(const std::string& name, const std::vector<uint32_t>& frame, FrameSize size, int repeat,
+                    std::vector<std::unique_ptr<hlsimproc::HostCannyEngine> >& host_engines) {
+        const size_t num_pixels = size_t(BENCH_MAX_WIDTH) * BENCH_MAX_HEIGHT;
+        std::vector<uint8_t> gray(num_pixels), gauss(num_pixels), nms(num_pixels);
+        std::vector<uint8_t> padded(num_pixels), hyst(num_pixels), comp(num_pixels), fused(num_pixels);
+        std::vector<GradPix> grad(num_pixels);
+        std::vector<uint8_t> host_edge(size_t(size.width) * size.height);
+        hls::stream<ImAxis<24> > axis_in, axis_out;
+        const uint32_t w = size.width;
+        const uint32_t h = size.height;
+
+        // pixels are stored with a line stride of BENCH_MAX_WIDTH as in the top functions
+        Result result;
+        result.frame = name;
+        result.size  = size;
+
+        StageResult stage;
+        stage.name = "AXIS2GrayArray";
+        stage.ns_per_pixel = MedianNsPerPixel(repeat, size, [&] { PushFrame(frame, size, axis_in); }, [&] {
+            HlsImProc::AXIS2GrayArray<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(axis_in, gray.data(), w, h);
+        });
+        result.stages.push_back(stage);
+
+        stage.name = "GaussianBlur";
+        stage.ns_per_pixel = MedianNsPerPixel(repeat, size, NoPrepare, [&] {
+            HlsImProc::GaussianBlur<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(gray.data(), gauss.data(), w, h);
+        });
+        result.stages.push_back(stage);
+
+        stage.name = "Sobel";
+        stage.ns_per_pixel = MedianNsPerPixel(repeat, size, NoPrepare, [&] {
+            HlsImProc::Sobel<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(gauss.data(), grad.data(), w, h);
+        });
+        result.stages.push_back(stage);
+
+        stage.name = "NonMaxSuppression";
+        stage.ns_per_pixel = MedianNsPerPixel(repeat, size, NoPrepare, [&] {
+            HlsImProc::NonMaxSuppression<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(grad.data(), nms.data(), w, h);
+        });
+        result.stages.push_back(stage);
+
+        stage.name = "ZeroPadding";
+        stage.ns_per_pixel = MedianNsPerPixel(repeat, size, NoPrepare, [&] {
+            HlsImProc::ZeroPadding<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(nms.data(), padded.data(), PADDING_SIZE, w, h);
+        });
+        result.stages.push_back(stage);
+
+        stage.name = "HystThreshold";
+        stage.ns_per_pixel = MedianNsPerPixel(repeat, size, NoPrepare, [&] {
+            HlsImProc::HystThreshold<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(padded.data(), hyst.data(),
+                                                                        BENCH_HTHR, BENCH_LTHR, w, h);
+        });
+        result.stages.push_back(stage);
+
+        stage.name = "HystThresholdComp";
+        stage.ns_per_pixel = MedianNsPerPixel(repeat, size, NoPrepare, [&] {
+            HlsImProc::HystThresholdComp<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(hyst.data(), comp.data(), w, h);
+        });
+        result.stages.push_back(stage);
+
+        stage.name = "GrayArray2AXIS";
+        stage.ns_per_pixel = MedianNsPerPixel(repeat, size, [&] { DrainFrame(axis_out); }, [&] {
+            HlsImProc::GrayArray2AXIS<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(comp.data(), axis_out, w, h);
+        });
+        result.stages.push_back(stage);
+
+        result.pipeline_ns_per_pixel = 0;
+        for(size_t i = 0; i < result.stages.size(); i++) {
+            result.pipeline_ns_per_pixel += result.stages[i].ns_per_pixel;
+        }
+
+        result.fused_ns_per_pixel = MedianNsPerPixel(repeat, size, [&] {
+            DrainFrame(axis_out);
+            PushFrame(frame, size, axis_in);
+        }, [&] {
+            HlsImProc::AXIS2GrayArray<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(axis_in, gray.data(), w, h);
+            HlsImProc::CannyFused<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(gray.data(), fused.data(),
+                                                                     BENCH_HTHR, BENCH_LTHR, PADDING_SIZE, w, h);
+            HlsImProc::GrayArray2AXIS<BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT>(fused.data(), axis_out, w, h);
+        });
+
+        for(size_t e = 0; e < host_engines.size(); e++) {
+            hlsimproc::HostCannyEngine& host_engine = *host_engines[e];
+            HostResult host;
+            host.threads = host_engine.NumThreads();
+            host.ns_per_pixel = MedianNsPerPixel(repeat, size, NoPrepare, [&] {
+                host_engine.Process(frame.data(), host_edge.data(), w, h, BENCH_HTHR, BENCH_LTHR);
+            });
+            result.hosts.push_back(host);
+        }
+
+        return result;
+    }
+
+    void PrintResult(const Result& result) {
+        printf("%-9s %4u x %4u :", result.frame.c_str(), result.size.width, result.size.height);
+        printf(" pipeline %7.2f MP/s, fused %7.2f MP/s\n",
+               1e3 / result.pipeline_ns_per_pixel, 1e3 / result.fused_ns_per_pixel);
+        for(size_t i = 0; i < result.hosts.size(); i++) {
+            printf("    host %3u threads   %8.2f MP/s\n", result.hosts[i].threads, 1e3 / result.hosts[i].ns_per_pixel);
+        }
+        for(size_t i = 0; i < result.stages.size(); i++) {
+            printf("    %-18s %8.2f ns/pixel\n", result.stages[i].name.c_str(), result.stages[i].ns_per_pixel);
+        }
+    }
+
+    bool WriteJson(const char* filename, const std::vector<Result>& results, int repeat) {
+        FILE* fp = fopen(filename, "w");
+        if(fp == NULL) {
+            return false;
+        }
+        fprintf(fp, "{\n  \"repeat\": %d,\n  \"results\": [\n", repeat);
+        for(size_t r = 0; r < results.size(); r++) {
+            const Result& result = results[r];
+            fprintf(fp, "    {\n");
+            fprintf(fp, "      \"frame\": \"%s\",\n", result.frame.c_str());
+            fprintf(fp, "      \"width\": %u,\n      \"height\": %u,\n", result.size.width, result.size.height);
+            fprintf(fp, "      \"pipeline_mpix_per_s\": %.3f,\n", 1e3 / result.pipeline_ns_per_pixel);
+            fprintf(fp, "      \"fused_mpix_per_s\": %.3f,\n", 1e3 / result.fused_ns_per_pixel);
+            fprintf(fp, "      \"host_engine_mpix_per_s\": {\n");
+            for(size_t i = 0; i < result.hosts.size(); i++) {
+                fprintf(fp, "        \"%u\": %.3f%s\n", result.hosts[i].threads, 1e3 / result.hosts[i].ns_per_pixel,
+                        (i + 1 < result.hosts.size()) ? "," : "");
+            }
+            fprintf(fp, "      },\n");
+            fprintf(fp, "      \"stage_ns_per_pixel\": {\n");
+            for(size_t i = 0; i < result.stages.size(); i++) {
+                fprintf(fp, "        \"%s\": %.3f%s\n", result.stages[i].name.c_str(), result.stages[i].ns_per_pixel,
+                        (i + 1 < result.stages.size()) ? "," : "");
+            }
+            fprintf(fp, "      }\n    }%s\n", (r + 1 < results.size()) ? "," : "");
+        }
+        fprintf(fp, "  ]\n}\n");
+        return fclose(fp) == 0;
+    }
+
+    bool ParseSizes(const char* arg, std::vector<FrameSize>& sizes) {
+        sizes.clear();
+        std::string list(arg);
+        size_t pos = 0;
+        while(pos < list.size()) {
+            size_t end = list.find(',', pos);
+            if(end == std::string::npos) {
+                end = list.size();
+            }
+            FrameSize size;
+            if(sscanf(list.substr(pos, end - pos).c_str(), "%ux%u", &size.width, &size.height) != 2 ||
+               size.width == 0 || size.height == 0 ||
+               size.width > BENCH_MAX_WIDTH || size.height > BENCH_MAX_HEIGHT) {
+                return false;
+            }
+            sizes.push_back(size);
+            pos = end + 1;
+        }
+        return !sizes.empty();
+    }
+
+    // thread counts of the host engine (0 : all hardware threads)
+    bool ParseThreads(const char* arg, std::vector<uint32_t>& threads) {
+        threads.clear();
+        std::string list(arg);
+        size_t pos = 0;
+        while(pos < list.size()) {
+            size_t end = list.find(',', pos);
+            if(end == std::string::npos) {
+                end = list.size();
+            }
+            uint32_t num_threads;
+            if(sscanf(list.substr(pos, end - pos).c_str(), "%u", &num_threads) != 1 || num_threads > 256) {
+                return false;
+            }
+            threads.push_back(num_threads);
+            pos = end + 1;
+        }
+        return !threads.empty();
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* json_file  = NULL;
+    const char* image_file = NULL;
+    int repeat = 3;
+    const FrameSize DEFAULT_SIZES[] = { {256, 256}, {640, 480}, {1280, 720}, {1920, 1080}, {3840, 2160} };
+    std::vector<FrameSize> sizes(DEFAULT_SIZES, DEFAULT_SIZES + sizeof(DEFAULT_SIZES) / sizeof(DEFAULT_SIZES[0]));
+    std::vector<uint32_t> threads(1, 0);
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_file = argv[++i];
+        }
+        else if(strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, atoi(argv[++i]));
+        }
+        else if(strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            image_file = argv[++i];
+        }
+        else if(strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            if(!ParseSizes(argv[++i], sizes)) {
+                fprintf(stderr, "bad --sizes (WxH,... up to %dx%d)\n", BENCH_MAX_WIDTH, BENCH_MAX_HEIGHT);
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            if(!ParseThreads(argv[++i], threads)) {
+                fprintf(stderr, "bad --threads (N,... up to 256, 0 for all hardware threads)\n");
+                return 1;
+            }
+        }
+        else {
+            fprintf(stderr, "usage: %s [--json FILE] [--repeat N] [--image PNG] [--sizes WxH,WxH,...] [--threads N,N,...]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<uint32_t> image;
+    FrameSize image_size = {0, 0};
+    if(image_file != NULL) {
+#ifdef HLSIMPROC_BENCH_PNG
+        if(!LoadPng(image_file, image, image_size)) {
+            fprintf(stderr, "cannot read %s\n", image_file);
+            return 1;
+        }
+#else
+        fprintf(stderr, "built without libpng, --image is not supported\n");
+        return 1;
+#endif
+    }
+
+    std::vector<std::unique_ptr<hlsimproc::HostCannyEngine> > host_engines;
+    for(size_t t = 0; t < threads.size(); t++) {
+        host_engines.emplace_back(new hlsimproc::HostCannyEngine(threads[t]));
+    }
+    std::vector<Result> results;
+    for(size_t s = 0; s < sizes.size(); s++) {
+        results.push_back(RunFrame("synthetic", SyntheticFrame(sizes[s]), sizes[s], repeat, host_engines));
+        PrintResult(results.back());
+        if(!image.empty()) {
+            results.push_back(RunFrame("image", TiledFrame(image, image_size, sizes[s]), sizes[s], repeat, host_engines));
+            PrintResult(results.back());
+        }
+    }
+
+    if(json_file != NULL && !WriteJson(json_file, results, repeat)) {
+        fprintf(stderr, "cannot write %s\n", json_file);
+        return 1;
+    }
+    return 0;
+}
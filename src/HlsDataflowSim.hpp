@@ -0,0 +1,267 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2019 Yuya Kudo.
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SRC_HLS_DATAFLOW_SIM_HPP_
+#define SRC_HLS_DATAFLOW_SIM_HPP_
+
+// host-only model of a DATAFLOW region (never seen by synthesis)
+#ifndef __SYNTHESIS__
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace hlsimproc {
+    // statistics of a FIFO channel
+    struct FifoStats {
+        uint64_t full_stalls;  // writes that found the FIFO full (back-pressure from consumer)
+        uint64_t empty_stalls; // reads that found the FIFO empty (starvation from producer)
+    };
+
+    // cycle of the calling DATAFLOW process in the timed model of SpscFifo
+    // (0 when the thread of the process starts)
+    inline uint64_t& ProcessCycle() {
+        static thread_local uint64_t cycle = 0;
+        return cycle;
+    }
+
+    // bounded lock-free single-producer single-consumer FIFO
+    // (behaves like a channel made by "#pragma HLS STREAM depth=DEPTH")
+    //
+    // every access also advances ProcessCycle() of its thread by a cycle model:
+    // each end of the FIFO takes one access per cycle, an element can be read
+    // the cycle after it is written, and a full slot can be written in the cycle
+    // it is read (pipeline latency inside a process is not modelled)
+    template<typename T, uint32_t DEPTH>
+    class SpscFifo {
+        public:
+        typedef T value_type;
+
+        SpscFifo() : head_(0), tail_(0), full_stalls_(0), empty_stalls_(0),
+                     last_write_cycle_(0), last_read_cycle_(0), read_log_(NULL) {}
+
+        // blocking write (producer thread only)
+        void write(const T& value) {
+            const uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if(tail - head_.load(std::memory_order_acquire) == DEPTH) {
+                full_stalls_++;
+                while(tail - head_.load(std::memory_order_acquire) == DEPTH) {
+                    std::this_thread::yield();
+                }
+            }
+            uint64_t cycle = ProcessCycle();
+            if(tail != 0) {
+                cycle = std::max(cycle, last_write_cycle_ + 1);
+            }
+            if(tail >= DEPTH) {
+                cycle = std::max(cycle, read_cycle_[tail % DEPTH]);
+            }
+            ProcessCycle() = last_write_cycle_ = cycle;
+
+            buf_[tail % DEPTH] = value;
+            write_cycle_[tail % DEPTH] = cycle;
+            tail_.store(tail + 1, std::memory_order_release);
+        }
+
+        // blocking read (consumer thread only)
+        T read() {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            if(tail_.load(std::memory_order_acquire) == head) {
+                empty_stalls_++;
+                while(tail_.load(std::memory_order_acquire) == head) {
+                    std::this_thread::yield();
+                }
+            }
+            uint64_t cycle = std::max(ProcessCycle(), write_cycle_[head % DEPTH] + 1);
+            if(head != 0) {
+                cycle = std::max(cycle, last_read_cycle_ + 1);
+            }
+            ProcessCycle() = last_read_cycle_ = cycle;
+            if(read_log_ != NULL) {
+                read_log_->push_back(cycle);
+            }
+
+            T value = buf_[head % DEPTH];
+            read_cycle_[head % DEPTH] = cycle;
+            head_.store(head + 1, std::memory_order_release);
+            return value;
+        }
+
+        // non-blocking write (producer thread only): false when the slot of the element has not been
+        // read by the cycle of the write, which then takes that cycle (the write waits until the consumer
+        // has read the slot, so the result is the same on every run)
+        bool write_nb(const T& value) {
+            const uint64_t tail = tail_.load(std::memory_order_relaxed);
+            while(tail - head_.load(std::memory_order_acquire) == DEPTH) {
+                std::this_thread::yield();
+            }
+            uint64_t cycle = ProcessCycle();
+            if(tail != 0) {
+                cycle = std::max(cycle, last_write_cycle_ + 1);
+            }
+            if(tail >= DEPTH && read_cycle_[tail % DEPTH] > cycle) {
+                full_stalls_++;
+                ProcessCycle() = cycle + 1;
+                return false;
+            }
+            write(value);
+            return true;
+        }
+
+        // non-blocking read (consumer thread only): false when no element has been written before the
+        // cycle of the read, which then takes that cycle (the read waits until the producer has written
+        // the element, so the result is the same on every run)
+        bool read_nb(T& value) {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            while(tail_.load(std::memory_order_acquire) == head) {
+                std::this_thread::yield();
+            }
+            uint64_t cycle = ProcessCycle();
+            if(head != 0) {
+                cycle = std::max(cycle, last_read_cycle_ + 1);
+            }
+            if(write_cycle_[head % DEPTH] + 1 > cycle) {
+                empty_stalls_++;
+                ProcessCycle() = cycle + 1;
+                return false;
+            }
+            value = read();
+            return true;
+        }
+
+        // store the cycle of every read to log (set before the consumer starts)
+        void SetReadLog(std::vector<uint64_t>* log) {
+            read_log_ = log;
+        }
+
+        // valid after both ends have finished
+        FifoStats stats() const {
+            FifoStats s;
+            s.full_stalls  = full_stalls_;
+            s.empty_stalls = empty_stalls_;
+            return s;
+        }
+
+        private:
+        SpscFifo(const SpscFifo&);
+        SpscFifo& operator=(const SpscFifo&);
+
+        // keep consumer and producer indices on separate cache lines
+        alignas(64) std::atomic<uint64_t> head_;
+        alignas(64) std::atomic<uint64_t> tail_;
+        alignas(64) uint64_t full_stalls_;  // touched by producer only
+        alignas(64) uint64_t empty_stalls_; // touched by consumer only
+        uint64_t last_write_cycle_;         // producer only
+        uint64_t last_read_cycle_;          // consumer only
+        std::vector<uint64_t>* read_log_;   // consumer only
+        T buf_[DEPTH];
+        uint64_t write_cycle_[DEPTH];       // cycle each element was written
+        uint64_t read_cycle_[DEPTH];        // cycle the previous element of each slot was read
+    };
+
+    // src side of a FIFO for HlsImProc stages (index is ignored, access is in raster order)
+    template<typename FIFO_T>
+    class FifoReader {
+        public:
+        explicit FifoReader(FIFO_T& fifo) : fifo_(&fifo) {}
+        typename FIFO_T::value_type operator[](uint32_t) const {
+            return fifo_->read();
+        }
+
+        private:
+        FIFO_T* fifo_;
+    };
+
+    // dst side of a FIFO for HlsImProc stages (index is ignored, access is in raster order)
+    template<typename FIFO_T>
+    class FifoWriter {
+        public:
+        class Ref {
+            public:
+            explicit Ref(FIFO_T* fifo) : fifo_(fifo) {}
+            Ref& operator=(const typename FIFO_T::value_type& value) {
+                fifo_->write(value);
+                return *this;
+            }
+
+            private:
+            FIFO_T* fifo_;
+        };
+
+        explicit FifoWriter(FIFO_T& fifo) : fifo_(&fifo) {}
+        Ref operator[](uint32_t) const {
+            return Ref(fifo_);
+        }
+
+        private:
+        FIFO_T* fifo_;
+    };
+
+    template<typename FIFO_T>
+    inline FifoReader<FIFO_T> ReadPort(FIFO_T& fifo) {
+        return FifoReader<FIFO_T>(fifo);
+    }
+
+    template<typename FIFO_T>
+    inline FifoWriter<FIFO_T> WritePort(FIFO_T& fifo) {
+        return FifoWriter<FIFO_T>(fifo);
+    }
+
+    // runs every process of a DATAFLOW region on its own thread
+    class DataflowRegion {
+        public:
+        DataflowRegion() {}
+        ~DataflowRegion() {
+            Join();
+        }
+
+        template<typename F>
+        void Spawn(F process) {
+            threads_.push_back(std::thread(process));
+        }
+
+        // wait for all processes to finish
+        void Join() {
+            for(size_t i = 0; i < threads_.size(); i++) {
+                if(threads_[i].joinable()) {
+                    threads_[i].join();
+                }
+            }
+            threads_.clear();
+        }
+
+        private:
+        DataflowRegion(const DataflowRegion&);
+        DataflowRegion& operator=(const DataflowRegion&);
+
+        std::vector<std::thread> threads_;
+    };
+}
+
+#endif /* __SYNTHESIS__ */
+
+#endif /* SRC_HLS_DATAFLOW_SIM_HPP_ */
@@ -39,51 +39,631 @@ namespace hlsimproc {
         DIR_135
     };
 
+    // gradient magnitude of Sobel (saturated to 255)
+    enum MagMode {
+        MAG_EXACT, // sqrt(gx^2 + gy^2) by float square root
+        MAG_ISQRT, // sqrt(gx^2 + gy^2) by integer square root (same output as MAG_EXACT)
+        MAG_L1,    // |gx| + |gy|
+        MAG_AMBM   // alpha max plus beta min (15/16 max(|gx|, |gy|) + 15/32 min(|gx|, |gy|))
+    };
+
+    // pixel format of the input AXI4-Stream
+    enum PixFormat {
+        PIX_RGB24,        // 24bit BGR (B in bits 7..0), luma by BT.601
+        PIX_Y8,           // 8bit luma
+        PIX_YUV422,       // 16bit YUV 4:2:2 (Y in bits 7..0, U/V alternately in bits 15..8)
+        PIX_BAYER_G,      // 8bit raw Bayer RGGB, green channel (mean of the two greens at R/B sites)
+        PIX_BAYER_BIN     // 8bit raw Bayer RGGB, luma of the 2x2 (R, G, G, B) window ending at the pixel
+    };
+
+    // bits per pixel of each PixFormat
+    template<PixFormat FMT>
+    struct PixFormatBits {
+        static const int value = (FMT == PIX_RGB24) ? 24 : (FMT == PIX_YUV422) ? 16 : 8;
+    };
+
+    //-- compile-time coefficients of the separable Gaussian kernel of GaussianBlur
+    //   (C++11 constexpr, so evaluated by the compiler and not by the fabric)
+    // n choose k
+    constexpr int GaussBinomial(int n, int k) {
+        return (k == 0 || k == n) ? 1 : GaussBinomial(n - 1, k - 1) + GaussBinomial(n - 1, k);
+    }
+    // e^x of 0 <= x < 2 by Taylor series (terms from the i-th, term is the (i-1)-th)
+    constexpr double GaussExpSeries(double x, int i, double term) {
+        return (i > 24) ? 0.0 : term * x / i + GaussExpSeries(x, i + 1, term * x / i);
+    }
+    // e^x for x >= 0 (e^(x/16) raised to the 16th power)
+    constexpr double GaussExpSquare(double e, int n) {
+        return (n == 0) ? e : GaussExpSquare(e * e, n - 1);
+    }
+    constexpr double GaussExp(double x) {
+        return (x < 0) ? 1.0 / GaussExp(-x) : GaussExpSquare(1.0 + GaussExpSeries(x / 16, 1, 1.0), 4);
+    }
+    // sampled Gaussian at distance d from the center (sigma = sigma_x100 / 100)
+    constexpr double GaussWeight(int d, int sigma_x100) {
+        return GaussExp(-0.5 * (d * 100.0 / sigma_x100) * (d * 100.0 / sigma_x100));
+    }
+    constexpr double GaussWeightSum(int size, int sigma_x100, int k) {
+        return (k == size) ? 0.0 : GaussWeight(k - size / 2, sigma_x100) + GaussWeightSum(size, sigma_x100, k + 1);
+    }
+    // weight of tap k scaled to 256 and rounded
+    constexpr int GaussRound(int size, int sigma_x100, int k) {
+        return int(GaussWeight(k - size / 2, sigma_x100) / GaussWeightSum(size, sigma_x100, 0) * 256 + 0.5);
+    }
+    constexpr int GaussRoundSum(int size, int sigma_x100, int k) {
+        return (k == size) ? 0 : GaussRound(size, sigma_x100, k) + GaussRoundSum(size, sigma_x100, k + 1);
+    }
+    // tap k of the 1D kernel: binomial (sum 2^(size-1)) when sigma_x100 is 0, otherwise
+    // the sampled Gaussian with the rounding error put on the center tap (sum 256)
+    constexpr int GaussCoef(int size, int sigma_x100, int k) {
+        return (k < 0 || k >= size) ? 0 :
+               (sigma_x100 == 0) ? GaussBinomial(size - 1, k) :
+               (k == size / 2) ? 256 - (GaussRoundSum(size, sigma_x100, 0) - GaussRound(size, sigma_x100, k)) :
+               GaussRound(size, sigma_x100, k);
+    }
+
+    // 1D kernel of KSIZE (3, 5 or 7) taps, SIGMA_X100 = 100 * sigma (0 : binomial 1-2-1, 1-4-6-4-1, ...)
+    // the 2D kernel is COEF[y] * COEF[x] and its sum is 1 << (2 * SHIFT)
+    template<int KSIZE, int SIGMA_X100 = 0>
+    struct GaussKernel {
+        static_assert(KSIZE == 3 || KSIZE == 5 || KSIZE == 7, "Gaussian kernel size must be 3, 5 or 7");
+        static_assert(SIGMA_X100 >= 0, "sigma must not be negative");
+        static const int SHIFT = (SIGMA_X100 == 0) ? KSIZE - 1 : 8;
+        static constexpr int COEF[7] = { GaussCoef(KSIZE, SIGMA_X100, 0), GaussCoef(KSIZE, SIGMA_X100, 1),
+                                         GaussCoef(KSIZE, SIGMA_X100, 2), GaussCoef(KSIZE, SIGMA_X100, 3),
+                                         GaussCoef(KSIZE, SIGMA_X100, 4), GaussCoef(KSIZE, SIGMA_X100, 5),
+                                         GaussCoef(KSIZE, SIGMA_X100, 6) };
+    };
+    template<int KSIZE, int SIGMA_X100>
+    constexpr int GaussKernel<KSIZE, SIGMA_X100>::COEF[7];
+
     // struct for image flowing through AXI4-Stream
-    template<int D>
+    // (PPC pixels per beat, pixel p in data[D*p+D-1 : D*p])
+    template<int D, int PPC = 1, int DEST_W = 1>
     struct ImAxis {
-        ap_uint<D> data;
+        ap_uint<D * PPC> data;
         ap_uint<1> user;
         ap_uint<1> last;
+        ap_uint<DEST_W> dest; // TDEST : ID of the source stream (0 when there is only one)
+    };
+
+    // pixel that have gradient info packed in 10 bits
+    // (bits 7..0 : gradient magnitude, bits 9..8 : GradDir)
+    typedef ap_uint<10> GradPix;
+#ifndef __SYNTHESIS__
+    static_assert(sizeof(GradPix) == 2, "GradPix must be stored in 2 bytes in the C simulation");
+#endif
+
+    inline GradPix MakeGradPix(uint8_t value, GradDir grad) {
+        #pragma HLS INLINE
+        GradPix pix;
+        pix.range(7, 0) = value;
+        pix.range(9, 8) = int(grad);
+        return pix;
+    }
+
+    inline uint8_t GradValue(const GradPix& pix) {
+        #pragma HLS INLINE
+        return pix.range(7, 0).to_uint();
+    }
+
+    inline GradDir GradDirection(const GradPix& pix) {
+        #pragma HLS INLINE
+        return GradDir(pix.range(9, 8).to_uint());
+    }
+
+    // signed Sobel gradient of a pixel packed in 22 bits (SobelXY)
+    // (bits 10..0 : gx = left - right, bits 21..11 : gy = top - bottom, each -1020 ~ 1020)
+    typedef ap_uint<22> GradXY;
+
+    inline GradXY MakeGradXY(const ap_int<11>& gx, const ap_int<11>& gy) {
+        #pragma HLS INLINE
+        GradXY pix;
+        pix.range(10, 0) = gx;
+        pix.range(21, 11) = gy;
+        return pix;
+    }
+
+    inline int GradX(const GradXY& pix) {
+        #pragma HLS INLINE
+        return ap_int<11>(pix.range(10, 0)).to_int();
+    }
+
+    inline int GradY(const GradXY& pix) {
+        #pragma HLS INLINE
+        return ap_int<11>(pix.range(21, 11)).to_int();
+    }
+
+    // label of a connected component (HystLabel/HystResolve)
+    typedef uint16_t CompLabel;
+
+    // gradient histogram of HystThresholdAdaptive kept between frames
+    // (two banks of 256 bins for each of the PPC pixels of a beat: one bank is built
+    // from the current frame while the other one, built from the previous frame,
+    // is turned into thresholds and cleared)
+    // zero initialized (e.g. static) before the first frame
+    template<int PPC = 1>
+    struct HystHistogram {
+        uint32_t bins[2][PPC][256];
+        uint32_t count[2];  // non-zero pixels of each bank
+        uint8_t bank;       // bank built from the current frame
+        bool valid;         // hthr/lthr are derived from a frame
+        uint8_t hthr;
+        uint8_t lthr;
+    };
+
+    //-- angles of the Hough line transform of HoughAccumulate: theta = 180° * t / THETA_BINS and
+    //   cos/sin of it scaled to 1 << 14 (C++11 constexpr, so evaluated by the compiler and not by the fabric)
+    // 1 - x^2 / 2! + x^4 / 4! - ... (i = 1) or 1 - x^2 / 3! + x^4 / 5! - ... (i = 2) from the term (x2 = x^2)
+    constexpr double HoughSeries(double x2, int i, double term) {
+        return (i > 40) ? 0.0 : term + HoughSeries(x2, i + 2, -term * x2 / (i * (i + 1)));
+    }
+    constexpr int HoughRound(double v) {
+        return int(v * 16384 + ((v < 0) ? -0.5 : 0.5));
+    }
+    constexpr double HoughAngle(int bins, int t) {
+        return 3.14159265358979323846 * t / bins;
+    }
+    constexpr int HoughCos(int bins, int t) {
+        return HoughRound(HoughSeries(HoughAngle(bins, t) * HoughAngle(bins, t), 1, 1.0));
+    }
+    constexpr int HoughSin(int bins, int t) {
+        return HoughRound(HoughAngle(bins, t) * HoughSeries(HoughAngle(bins, t) * HoughAngle(bins, t), 2, 1.0));
+    }
+    // 0, 1, ..., N - 1 as a template parameter pack
+    template<int... I>
+    struct HoughIndex {};
+    template<int N, int... I>
+    struct HoughMakeIndex : HoughMakeIndex<N - 1, N - 1, I...> {};
+    template<int... I>
+    struct HoughMakeIndex<0, I...> {
+        typedef HoughIndex<I...> type;
+    };
+
+    template<int THETA_BINS, typename INDEX = typename HoughMakeIndex<THETA_BINS>::type>
+    struct HoughTrig;
+    template<int THETA_BINS, int... I>
+    struct HoughTrig<THETA_BINS, HoughIndex<I...> > {
+        static constexpr int COS[THETA_BINS] = { HoughCos(THETA_BINS, I)... };
+        static constexpr int SIN[THETA_BINS] = { HoughSin(THETA_BINS, I)... };
+    };
+    template<int THETA_BINS, int... I>
+    constexpr int HoughTrig<THETA_BINS, HoughIndex<I...> >::COS[THETA_BINS];
+    template<int THETA_BINS, int... I>
+    constexpr int HoughTrig<THETA_BINS, HoughIndex<I...> >::SIN[THETA_BINS];
+
+    // (rho, theta) accumulator of HoughAccumulate kept between frames (cleared while the peaks are
+    // searched at the end of each frame). An edge pixel votes the SECTOR_BINS angles of the 45° sector
+    // of its GradDir, so bank k holds the k-th angle of every sector, at sector * RHO_BINS + rho bin
+    // (rho from -WIDTH to WIDTH + HEIGHT in steps of 1 << RHO_SHIFT pixels)
+    // zero initialized (e.g. static) before the first frame
+    template<uint32_t WIDTH, uint32_t HEIGHT, int THETA_BINS, int RHO_SHIFT>
+    struct HoughAccumulator {
+        static const int SECTOR_BINS = THETA_BINS / 4;
+        static const int RHO_BINS = ((2 * WIDTH + HEIGHT) >> RHO_SHIFT) + 1;
+        ap_uint<16> bins[SECTOR_BINS][4 * RHO_BINS];
+    };
+
+    // counters of AXISInMonitor/AXISOutMonitor (accumulated over the frames, except edge_pixels)
+    // zero initialized (e.g. static) before the first frame
+    struct PerfCounters {
+        uint32_t frames;        // frames written to the output
+        uint32_t sof_discarded; // input beats discarded while waiting for the start of frame (user signal)
+        uint32_t short_lines;   // input lines whose last signal came before width pixels
+        uint32_t long_lines;    // input lines with beats after width pixels (discarded until the last signal)
+        uint32_t in_stalls;     // cycles inside a frame without an input beat (starvation)
+        uint32_t out_stalls;    // cycles the output did not accept a beat (back-pressure)
+        uint32_t edge_pixels;   // edge pixels (0xFF) of the last frame
+    };
+
+    // pixel of one of the time-multiplexed streams of the multi-stream stages
+    // (user : first pixel of a frame of the stream, dest : ID of the stream)
+    template<typename T, int DEST_W>
+    struct StreamPix {
+        T pix;
+        ap_uint<1> user;
+        ap_uint<DEST_W> dest;
+    };
+
+    // PPC pixels transferred in one clock (element of the arrays between the stages)
+    template<typename T, int PPC>
+    struct PixBeat {
+        T pix[PPC];
+    };
+
+    // one pixel per clock converts from/to the pixel itself,
+    // so the arrays between the stages stay plain pixel arrays
+    template<typename T>
+    struct PixBeat<T, 1> {
+        T pix[1];
+
+        PixBeat() {}
+        PixBeat(const T& value) {
+            pix[0] = value;
+        }
+        operator T() const {
+            return pix[0];
+        }
+    };
+
+    // line buffer that completes the column of the last ROWS lines at every pixel:
+    // ROWS - 1 previous lines are stored and the current pixel is the bottom of the column.
+    // the lines stay in place and a circular row index points at the oldest one,
+    // which the current line overwrites, instead of shifting every row at every pixel
+    template<typename T, int ROWS, uint32_t WIDTH, int PPC = 1>
+    class LineBuffer {
+        static_assert(ROWS >= 2, "LineBuffer needs at least one stored line");
+
+        public:
+        LineBuffer() : first_line_(true) {
+            #pragma HLS ARRAY_RESHAPE variable=buf_ cyclic factor=PPC dim=1
+            #pragma HLS ARRAY_RESHAPE variable=buf_ complete dim=2
+            for(int yl = 0; yl < ROWS - 1; yl++) {
+                row_[yl] = yl;
+            }
+        }
+
+        // at the first beat of every line (the oldest line moves to the next row)
+        void NextLine(bool first_line) {
+            #pragma HLS INLINE
+            for(int yl = 0; yl < ROWS - 1; yl++) {
+                row_[yl] = first_line ? yl : (row_[yl] == ROWS - 2) ? 0 : row_[yl] + 1;
+            }
+            first_line_ = first_line;
+        }
+
+        // writes pixel xi of the current line and reads its column
+        // (col[0] is the oldest line and col[ROWS - 1] is pix).
+        // the first line of a frame clears the other rows, so rows above the frame read as zero
+        void Insert(int xi, const T& pix, T col[ROWS]) {
+            #pragma HLS INLINE
+            if(first_line_) {
+                for(int yl = 0; yl < ROWS - 1; yl++) {
+                    col[yl] = T(0);
+                    buf_[xi][yl] = (yl == 0) ? pix : T(0);
+                }
+            }
+            else {
+                for(int yl = 0; yl < ROWS - 1; yl++) {
+                    col[yl] = buf_[xi][row_[yl]];
+                }
+                buf_[xi][row_[0]] = pix;
+            }
+            col[ROWS - 1] = pix;
+        }
+
+        private:
+        T buf_[WIDTH][ROWS - 1]; // column xi of every stored line in one word
+        int row_[ROWS - 1];      // row of each line of the column (row_[0] is overwritten by the current line)
+        bool first_line_;
     };
 
-    // struct of pixel that have gradient info
-    struct GradPix {
-        uint8_t value;
-        GradDir grad;
+    // ROWS x K window sliding over the columns of a LineBuffer, PPC - 1 columns wider
+    // so that it holds the window of every pixel of a beat
+    // (ROWS = 1 slides over single values, e.g. the vertical sums of a separable filter)
+    template<typename T, int K, int PPC = 1, int ROWS = K>
+    class SlidingWindow {
+        public:
+        SlidingWindow() {
+            #pragma HLS ARRAY_PARTITION variable=buf_ complete dim=0
+        }
+
+        // shifts the window by one beat (columns left of the frame are cleared at the first pixel)
+        void Shift(bool first_pix) {
+            #pragma HLS INLINE
+            for(int yw = 0; yw < ROWS; yw++) {
+                for(int xw = 0; xw < K - 1; xw++) {
+                    buf_[yw][xw] = first_pix ? T(0) : buf_[yw][xw + PPC];
+                }
+            }
+        }
+
+        // writes the column of the p-th pixel of the beat
+        void Insert(int p, const T col[ROWS]) {
+            #pragma HLS INLINE
+            for(int yw = 0; yw < ROWS; yw++) {
+                buf_[yw][K - 1 + p] = col[yw];
+            }
+        }
+
+        // window of the p-th pixel of the beat
+        void Get(int p, T pix_window[ROWS][K]) const {
+            #pragma HLS INLINE
+            for(int yw = 0; yw < ROWS; yw++) {
+                for(int xw = 0; xw < K; xw++) {
+                    pix_window[yw][xw] = buf_[yw][p + xw];
+                }
+            }
+        }
+
+        private:
+        T buf_[ROWS][K + PPC - 1];
     };
 
+    // every stage reads src and writes dst exactly once per beat in raster order,
+    // so SRC_T/DST_T may be plain arrays (mapped to FIFOs by "#pragma HLS STREAM")
+    // or any type that provides the same operator[] (e.g. host-side FIFO adapters)
+    //
+    // PPC is the number of pixels processed per clock (WIDTH must be a multiple of it).
+    // the elements of src/dst are PixBeat<T, PPC>, i.e. plain pixels when PPC = 1,
+    // and the output is the same as PPC = 1 for any PPC
+    //
+    // width/height is the frame size at run time (the loops run width x height pixels),
+    // WIDTH/HEIGHT is the maximum frame size that sizes the line buffers
     class HlsImProc {
         public:
         // AXI4-Stream -> GrayScale image
-        template<uint32_t WIDTH, uint32_t HEIGHT>
-        static void AXIS2GrayArray(hls::stream<ImAxis<24> >& axis_src, uint8_t* dst);
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename DST_T>
+        static void AXIS2GrayArray(hls::stream<ImAxis<24, PPC> >& axis_src, DST_T dst,
+                                   uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // AXI4-Stream of pixel format FMT -> GrayScale image (AXIS2GrayArray is FMT = PIX_RGB24)
+        template<uint32_t WIDTH, uint32_t HEIGHT, PixFormat FMT, int PPC, typename DST_T>
+        static void AXIS2LumaArray(hls::stream<ImAxis<PixFormatBits<FMT>::value, PPC> >& axis_src, DST_T dst,
+                                   uint32_t width = WIDTH, uint32_t height = HEIGHT);
         // GrayScale image -> AXI4-Stream
-        template<uint32_t WIDTH, uint32_t HEIGHT>
-        static void GrayArray2AXIS(uint8_t* src, hls::stream<ImAxis<24> >& axis_dst);
-        // gaussian bler
-        template<uint32_t WIDTH, uint32_t HEIGHT>
-        static void GaussianBlur(uint8_t* src, uint8_t* dst);
-        // sobel filter
-        template<uint32_t WIDTH, uint32_t HEIGHT>
-        static void Sobel(uint8_t* src, GradPix* dst);
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_T>
+        static void GrayArray2AXIS(SRC_T src, hls::stream<ImAxis<24, PPC> >& axis_dst,
+                                   uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // frame buffer of 32bit words (24bit RGB in the bits of the AXI4-Stream data) -> GrayScale image.
+        // line yi of the frame starts at src_mem[yi*stride] (stride >= width pixels),
+        // and each line is read in one pass of sequential addresses (one burst per line on m_axi)
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename DST_T>
+        static void Mem2GrayArray(const uint32_t* src_mem, DST_T dst, uint32_t stride,
+                                  uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // GrayScale image -> frame buffer of 8bit pixels at dst_mem[xi + yi*stride] (one burst per line on m_axi,
+        // the bytes between width and stride are not written)
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T>
+        static void GrayArray2Mem(SRC_T src, uint8_t* dst_mem, uint32_t stride,
+                                  uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // vertical stripe of a frame buffer -> GrayScale image of width x height pixels: column xi of the image
+        // is column win_x + xi of the frame, and the columns left of the frame (win_x < 0) are the end of the previous
+        // line (zero for the first line) as the windows of a full width frame see them at the start of a line
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename DST_T>
+        static void Mem2GrayArrayStripe(const uint32_t* src_mem, DST_T dst, uint32_t stride, int32_t win_x,
+                                        uint32_t width, uint32_t height, uint32_t frame_width);
+        // columns roi_x to roi_x + roi_width - 1 of the GrayScale image -> columns 0 to roi_width - 1
+        // of the frame buffer at dst_mem (the stripe of the output frame, stitched by dst_mem)
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T>
+        static void GrayArray2MemStripe(SRC_T src, uint8_t* dst_mem, uint32_t stride, uint32_t roi_x, uint32_t roi_width,
+                                        uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // binary edge image -> AXI4-Stream of BEAT_W / BPP pixels per beat (pixel xi of a beat in
+        // bits [BPP*xi+BPP-1 : BPP*xi], the last beat of a line is zero filled and has the last signal)
+        // BPP = 1 : 1 for edge (0xFF)
+        // BPP = 2 : 3 for strong (0xFF), 1 for weak (other non-zero, e.g. HystThreshold output), 0 for none
+        template<uint32_t WIDTH, uint32_t HEIGHT, int BPP, int BEAT_W, typename SRC_T>
+        static void GrayArray2AXISPacked(SRC_T src, hls::stream<ImAxis<BEAT_W> >& axis_dst,
+                                         uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // binary edge image -> AXI4-Stream of the edge pixels only
+        // (data[11:0] : x, data[23:12] : y, data[25:24] : GradDir, WIDTH/HEIGHT <= 4096),
+        // the frame is closed by a beat of the number of edge pixels with data[31] and the last signal set.
+        // grad_src is the Sobel output of the same frame: the edge at (x, y) is the gradient at (x - 2, y - 2)
+        // because NonMaxSuppression and HystThresholdComp each output the center of their window
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T, typename GRAD_T>
+        static void EdgeArray2AXISSparse(SRC_T src, GRAD_T grad_src, hls::stream<ImAxis<32> >& axis_dst,
+                                         uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // Hough line transform of the edge pixels (0xFF) of src into acc: an edge pixel at (x, y) votes
+        // rho = x cos(theta) + y sin(theta) for the THETA_BINS / 4 angles within 22.5° of its gradient direction
+        // (the GradDir of grad_src at (x - 2, y - 2), as EdgeArray2AXISSparse), and at the end of the frame
+        // the NUM_PEAKS largest cells (the largest angle of each sector and rho) are output in descending order,
+        // one beat each: data[11:0] : rho bin (rho = (bin << RHO_SHIFT) - WIDTH), data[19:12] : theta bin,
+        // data[31:20] : votes (saturated to 4095), the user signal on the first beat and the last signal on the last
+        template<uint32_t WIDTH, uint32_t HEIGHT, int NUM_PEAKS, int THETA_BINS, int RHO_SHIFT, typename SRC_T, typename GRAD_T>
+        static void HoughAccumulate(SRC_T src, GRAD_T grad_src, HoughAccumulator<WIDTH, HEIGHT, THETA_BINS, RHO_SHIFT>& acc,
+                                    hls::stream<ImAxis<32> >& axis_dst, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // signed gradient of SobelXY -> AXI4-Stream in step with the edge image (the gradient of the pixel of
+        // the HystThresholdComp output at (x, y) is the SobelXY output at (x - 2, y - 2), as EdgeArray2AXISSparse):
+        // one beat per pixel, data[15:0] : gx, data[31:16] : gy (int16), user/last signals as GrayArray2AXIS
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T>
+        static void GradArray2AXIS(SRC_T xy_src, hls::stream<ImAxis<32> >& axis_dst,
+                                   uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        //-- AXI4-Stream monitors in front of AXIS2GrayArray/behind GrayArray2AXIS: one beat per clock
+        //   in one flat loop, so the clocks without a beat are counted instead of stalling the loop
+        //   (the streams of ImAxis<D, PPC> are hls::stream or any FIFO with the same read_nb/write_nb/write,
+        //    e.g. SpscFifo of the dataflow model of C simulation)
+        // input frame from the start of frame on, counting sof_discarded, short_lines, long_lines and
+        // in_stalls of perf (the frame ends with the last signal of height lines, as AXIS2GrayArray reads it)
+        template<uint32_t WIDTH, uint32_t HEIGHT, int D, int PPC, typename SRC_S, typename DST_S>
+        static void AXISInMonitor(SRC_S& axis_src, DST_S& axis_dst,
+                                  PerfCounters& perf, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // output frame (width x height pixels), counting frames, out_stalls and edge_pixels of perf
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_S, typename DST_S>
+        static void AXISOutMonitor(SRC_S& axis_src, DST_S& axis_dst,
+                                   PerfCounters& perf, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // copy of src (beats of PixBeat<T, PPC>) to two destinations (fan-out of a FIFO to two DATAFLOW processes)
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename T, int PPC = 1, typename SRC_T, typename DST1_T, typename DST2_T>
+        static void Duplicate(SRC_T src, DST1_T dst1, DST2_T dst2, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // copy of src to dst and the 2:1 decimation of it in both directions to dst_half (the pixels at even columns
+        // of even lines, (width / 2) x (height / 2) pixels in lines of WIDTH / 2). src is expected to be low-pass
+        // filtered against aliasing, e.g. the GaussianBlur output, so one blur feeds two levels of a pyramid
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T, typename DST_T, typename HALF_T>
+        static void Decimate(SRC_T src, DST_T dst, HALF_T dst_half, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // copy of the grayscale image src to dst that compares each TILE_W x TILE_H tile with the previous frame:
+        // tile_sig keeps the CRC-32 of the pixels of every tile in raster order (tile tx + ty*tiles_x,
+        // tiles_x = ceil(width / TILE_W)) from the previous call, and tile_changed[i] is 1 when the CRC of tile i
+        // has changed, 0 otherwise (a change within 4 consecutive pixels always changes the CRC, and unlike a sum
+        // it is not left unchanged by changes of two pixels that cancel out)
+        template<uint32_t WIDTH, uint32_t HEIGHT, uint32_t TILE_W, uint32_t TILE_H, typename SRC_T, typename DST_T>
+        static void GrayTileChange(SRC_T src, DST_T dst,
+                                   uint32_t tile_sig[((WIDTH + TILE_W - 1) / TILE_W) * ((HEIGHT + TILE_H - 1) / TILE_H)],
+                                   uint8_t tile_changed[((WIDTH + TILE_W - 1) / TILE_W) * ((HEIGHT + TILE_H - 1) / TILE_H)],
+                                   uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // gaussian bler by the separable GaussKernel<KSIZE, SIGMA_X100> (KSIZE MACs for each pass)
+        // (output is delayed by KSIZE / 2 lines and pixels as the 5x5 kernel delays it by 2)
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, int KSIZE = 5, int SIGMA_X100 = 0,
+                 typename SRC_T, typename DST_T>
+        static void GaussianBlur(SRC_T src, DST_T dst, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // sobel filter (MAG selects how the gradient magnitude is computed)
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, MagMode MAG = MAG_EXACT, typename SRC_T, typename DST_T>
+        static void Sobel(SRC_T src, DST_T dst, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // Sobel that also outputs the signed gradient of each pixel to xy_dst (elements of PixBeat<GradXY, PPC>,
+        // zero where Sobel masks the magnitude at the boundary of the frame)
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, MagMode MAG = MAG_EXACT, typename SRC_T, typename DST_T, typename XY_T>
+        static void SobelXY(SRC_T src, DST_T dst, XY_T xy_dst, uint32_t width = WIDTH, uint32_t height = HEIGHT);
         // non-maximum suppression
-        template<uint32_t WIDTH, uint32_t HEIGHT>
-        static void NonMaxSuppression(GradPix* src, uint8_t* dst);
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, typename SRC_T, typename DST_T>
+        static void NonMaxSuppression(SRC_T src, DST_T dst, uint32_t width = WIDTH, uint32_t height = HEIGHT);
         // hysteresis threshold
-        template<uint32_t WIDTH, uint32_t HEIGHT>
-        static void HystThreshold(uint8_t* src, uint8_t* dst, uint8_t hthr, uint8_t lthr);
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, typename SRC_T, typename DST_T>
+        static void HystThreshold(SRC_T src, DST_T dst, uint8_t hthr, uint8_t lthr,
+                                  uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // hysteresis threshold with the thresholds derived from the histogram of the previous frame:
+        // hthr is the smallest magnitude that hist_pct / 256 of the non-zero pixels do not exceed,
+        // and lthr = hthr * hist_ratio / 256. hthr/lthr given here are used instead
+        // when adaptive is false or before the first frame has been seen
+        // (padding_size is that of the ZeroPadding before it: the thresholds are derived while
+        //  the zero padded rows go through, and before the first beat for what they do not cover)
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, typename SRC_T, typename DST_T>
+        static void HystThresholdAdaptive(SRC_T src, DST_T dst, HystHistogram<PPC>& hist,
+                                          uint8_t hthr, uint8_t lthr, bool adaptive,
+                                          uint8_t hist_pct, uint8_t hist_ratio, uint32_t padding_size,
+                                          uint32_t width = WIDTH, uint32_t height = HEIGHT);
         // comparison operation at neighboring pixels after exe hysteresis threshold
-        template<uint32_t WIDTH, uint32_t HEIGHT>
-        static void HystThresholdComp(uint8_t* src, uint8_t* dst);
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, typename SRC_T, typename DST_T>
+        static void HystThresholdComp(SRC_T src, DST_T dst, uint32_t width = WIDTH, uint32_t height = HEIGHT);
         // zero padding at boundary pixel
-        template<uint32_t WIDTH, uint32_t HEIGHT>
-        static void ZeroPadding(uint8_t* src, uint8_t* dst, uint32_t padding_size);
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, typename SRC_T, typename DST_T>
+        static void ZeroPadding(SRC_T src, DST_T dst, uint32_t padding_size,
+                                uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // GaussianBlur -> Sobel -> NonMaxSuppression -> ZeroPadding -> HystThreshold -> HystThresholdComp
+        // in one pipelined loop with one line buffer shared by all of them (same output)
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, MagMode MAG = MAG_EXACT, typename SRC_T, typename DST_T>
+        static void CannyFused(SRC_T src, DST_T dst, uint8_t hthr, uint8_t lthr, uint32_t padding_size,
+                               uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        //-- region of interest: the stages between these ones process only a window of the input frame
+        //   (width x height pixels at (win_x, win_y) of the frame_width x frame_height frame)
+        // AXI4-Stream -> GrayScale image of the window (the pixels around it are read and dropped;
+        // a window at a negative win_x starts each line with the last -win_x pixels of the line above,
+        // zero above the frame, as the line buffers of the stages see them in the full frame)
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename DST_T>
+        static void AXIS2GrayArrayRoi(hls::stream<ImAxis<24> >& axis_src, DST_T dst,
+                                      int32_t win_x, uint32_t win_y, uint32_t width, uint32_t height,
+                                      uint32_t frame_width = WIDTH, uint32_t frame_height = HEIGHT);
+        // zero padding at the boundary pixel of the frame (not of the window, which may start left of or above
+        // the frame at a negative win_x/win_y: those pixels are padded as well)
+        template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, typename SRC_T, typename DST_T>
+        static void ZeroPaddingRoi(SRC_T src, DST_T dst, uint32_t padding_size,
+                                   int32_t win_x, int32_t win_y, uint32_t width, uint32_t height,
+                                   uint32_t frame_width, uint32_t frame_height);
+        // GrayScale image of the window -> AXI4-Stream of its roi_width x roi_height pixels at (roi_x, roi_y)
+        template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T>
+        static void GrayArray2AXISRoi(SRC_T src, hls::stream<ImAxis<24> >& axis_dst,
+                                      uint32_t roi_x, uint32_t roi_y, uint32_t roi_width, uint32_t roi_height,
+                                      uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        //-- multi-stream stages: STREAMS sources time-multiplexed line by line (or frame by frame)
+        //   in any order, identified by TDEST. One call handles one frame of every stream
+        //   (STREAMS x height lines) and the line/window buffers of each stream are kept in its own bank,
+        //   so the output of each stream is the same as if it had the pipeline to itself
+        // AXI4-Stream (TDEST per line) -> GrayScale image
+        template<uint32_t WIDTH, uint32_t HEIGHT, int STREAMS, int DEST_W, typename DST_T>
+        static void AXIS2GrayArrayMulti(hls::stream<ImAxis<24, 1, DEST_W> >& axis_src, DST_T dst,
+                                        uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // GrayScale image -> AXI4-Stream (TDEST per line)
+        template<uint32_t WIDTH, uint32_t HEIGHT, int STREAMS, int DEST_W, typename SRC_T>
+        static void GrayArray2AXISMulti(SRC_T src, hls::stream<ImAxis<24, 1, DEST_W> >& axis_dst,
+                                        uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // CannyFused with per-stream line/window buffer banks and thresholds
+        template<uint32_t WIDTH, uint32_t HEIGHT, int STREAMS, int DEST_W, MagMode MAG = MAG_EXACT,
+                 typename SRC_T, typename DST_T>
+        static void CannyFusedMulti(SRC_T src, DST_T dst, const uint8_t hthr[STREAMS], const uint8_t lthr[STREAMS],
+                                    uint32_t padding_size, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // full hysteresis (1st pass) : label the connected components of weak/strong pixels
+        // (output of HystThreshold, 8-neighbourhood) with an equivalence table, which is resolved
+        // at the end of each line and of the frame (MAX_LABELS <= 65536). overflow is set when
+        // a component started after the table was full (weak ones are dropped from that frame)
+        template<uint32_t WIDTH, uint32_t HEIGHT, uint32_t MAX_LABELS, typename SRC_T>
+        static void HystLabel(SRC_T src, CompLabel label_buf[WIDTH * HEIGHT],
+                              CompLabel label_root[MAX_LABELS], bool label_strong[MAX_LABELS], bool& overflow,
+                              uint32_t width = WIDTH, uint32_t height = HEIGHT);
+        // full hysteresis (2nd pass) : 0xFF for the pixels of components that have a strong pixel
+        // (delayed by one line and one pixel as HystThresholdComp, which it replaces)
+        template<uint32_t WIDTH, uint32_t HEIGHT, uint32_t MAX_LABELS, typename DST_T>
+        static void HystResolve(const CompLabel label_buf[WIDTH * HEIGHT],
+                                const CompLabel label_root[MAX_LABELS], const bool label_strong[MAX_LABELS],
+                                DST_T dst, uint32_t width = WIDTH, uint32_t height = HEIGHT);
+
+        private:
+        // pixel operations on a window (shared by the stages above)
+        template<int KSIZE, int SIGMA_X100>
+        static ap_uint<16> GaussColumn(const uint8_t column[KSIZE]);
+        template<int KSIZE, int SIGMA_X100>
+        static uint8_t GaussRow(const ap_uint<16> vsum[KSIZE]);
+        static void SobelConv(const uint8_t window_buf[3][3], ap_int<11>& pix_h_sobel, ap_int<11>& pix_v_sobel);
+        template<MagMode MAG>
+        static GradPix SobelPix(const uint8_t window_buf[3][3]);
+        static uint8_t NonMaxSuppressionPix(const GradPix window_buf[3][3]);
+        static uint8_t HystThresholdPix(uint8_t pix, uint8_t hthr, uint8_t lthr);
+        // bin of the previous frame of HystThresholdAdaptive: added to cum and cleared,
+        // the thresholds of hist are set at the first bin where cum reaches target
+        template<int PPC>
+        static void HystHistogramBin(HystHistogram<PPC>& hist, int prev, int bin, uint32_t target,
+                                     uint8_t hist_ratio, uint32_t& cum, bool& found);
+        static uint8_t HystThresholdCompPix(const uint8_t window_buf[3][3]);
+
+        // CRC-32 (IEEE 802.3, reflected) of the bytes before data and data
+        static uint32_t Crc32Byte(uint32_t crc, uint8_t data);
+
+        // BT.601 luma of a 24bit BGR pixel
+        static uint8_t GrayPix(const ap_uint<24>& pix_data);
+        // luma of a raw Bayer RGGB pixel at (xi, yi) from the 2x2 window ending at it
+        // (pix_ul : upper left, pix_u : upper, pix_l : left, pix : the pixel)
+        template<PixFormat FMT>
+        static uint8_t BayerLumaPix(uint8_t pix_ul, uint8_t pix_u, uint8_t pix_l, uint8_t pix, int xi, int yi);
+
+        // rows kept by CannyFused for each operation in one word per column
+        // (the newest row of each window is produced in the same cycle)
+        struct FusedLineWord {
+            uint8_t gray[4];
+            uint8_t gauss[2];
+            GradPix grad[2];
+            uint8_t hyst[2];
+        };
+        // one beat of CannyFused: col (line buffer columns of the beat) is updated in place,
+        // and the window buffers are shifted (cleared when clear_win; gauss_win holds the
+        // vertical sums of the separable Gaussian kernel)
+        template<int PPC, MagMode MAG>
+        static PixBeat<uint8_t, PPC> CannyFusedBeat(const PixBeat<uint8_t, PPC>& pix_in, FusedLineWord col[PPC],
+                                                    ap_uint<16> gauss_win[5 + PPC - 1],
+                                                    uint8_t sobel_win[3][3 + PPC - 1],
+                                                    GradPix nms_win[3][3 + PPC - 1],
+                                                    uint8_t hyst_win[3][3 + PPC - 1],
+                                                    bool clear_win, int xb, int yi,
+                                                    uint8_t hthr, uint8_t lthr, uint32_t padding_size,
+                                                    uint32_t im_width, uint32_t im_height);
+
+        // copy of a SIZE x SIZE window buffer
+        template<int SIZE, typename T>
+        static void CopyWindow(const T src[SIZE][SIZE], T dst[SIZE][SIZE]);
+        // window of the p-th pixel of a beat (window_buf is PPC - 1 columns wider than it)
+        template<int SIZE, int COLS, typename T>
+        static void PixWindow(const T window_buf[SIZE][COLS], int p, T pix_window[SIZE][SIZE]);
     };
 
-    template<uint32_t WIDTH, uint32_t HEIGHT>
-    inline void HlsImProc::AXIS2GrayArray(hls::stream<ImAxis<24> >& axis_src, uint8_t* dst) {
-        ImAxis<24> axis_reader; // for read AXI4-Stream
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename DST_T>
+    inline void HlsImProc::AXIS2GrayArray(hls::stream<ImAxis<24, PPC> >& axis_src, DST_T dst,
+                                          uint32_t width, uint32_t height) {
+        #pragma HLS INLINE
+        AXIS2LumaArray<WIDTH, HEIGHT, PIX_RGB24>(axis_src, dst, width, height);
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, PixFormat FMT, int PPC, typename DST_T>
+    inline void HlsImProc::AXIS2LumaArray(hls::stream<ImAxis<PixFormatBits<FMT>::value, PPC> >& axis_src, DST_T dst,
+                                          uint32_t width, uint32_t height) {
+        const int BITS = PixFormatBits<FMT>::value;
+        const bool BAYER = (FMT == PIX_BAYER_G || FMT == PIX_BAYER_BIN);
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        ImAxis<BITS, PPC> axis_reader; // for read AXI4-Stream
+
+        // previous line and the last column of the previous beat (raw Bayer only)
+        LineBuffer<uint8_t, 2, WIDTH, PPC> line_buf;
+        uint8_t last_u = 0;
+        uint8_t last_l = 0;
+
         bool sof = false;        // Start of Frame
         bool eol = false;        // End of Line
 
@@ -97,17 +677,19 @@ namespace hlsimproc {
         }
 
         // image proc loop
-        for(int yi = 0; yi < HEIGHT; yi++) {
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
             eol = false;
-            for(int xi = 0; xi < WIDTH; xi++) {
+            for(int xb = 0; xb < line_beats; xb++) {
                 #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
                 #pragma HLS LOOP_FLATTEN off
 
                 // get pix until the last signal to be asserted
                 if(sof || eol) {
                     // when frame is started (first pix have already latched)
                     // or
-                    // when WIDTH param set more than actual frame size
+                    // when width param set more than actual frame size
                     sof = false;
                     eol = axis_reader.last.to_int();
                 }
@@ -116,29 +698,46 @@ namespace hlsimproc {
                     eol = axis_reader.last.to_int();
                 }
 
-                //--- grayscale processing
-                int pix_gray;
-
-                // Y = B*0.144 + G*0.587 + R*0.299
-                pix_gray = 9437*(axis_reader.data & 0x0000ff)
-                    + 38469*((axis_reader.data & 0x00ff00) >> 8 )
-                    + 19595*((axis_reader.data & 0xff0000) >> 16);
-
-                pix_gray >>= 16;
-
-                // to consider saturation
-                if(pix_gray < 0) {
-                    pix_gray = 0;
+                //--- luma processing
+                PixBeat<uint8_t, PPC> pix_out;
+                for(int p = 0; p < PPC; p++) {
+                    const ap_uint<BITS> pix_data = axis_reader.data.range(BITS*p + BITS - 1, BITS*p);
+                    if(FMT == PIX_RGB24) {
+                        pix_out.pix[p] = GrayPix(pix_data);
+                    }
+                    else if(!BAYER) {
+                        // Y8, or Y of YUV 4:2:2
+                        pix_out.pix[p] = pix_data.range(7, 0).to_uint();
+                    }
                 }
-                else if(pix_gray > 255) {
-                    pix_gray = 255;
+
+                //-- 2x2 window of raw Bayer (the row above the frame is cleared at the first line)
+                if(BAYER) {
+                    uint8_t pix_u[PPC];
+                    uint8_t pix[PPC];
+                    if(xb == 0) {
+                        line_buf.NextLine(yi == 0);
+                    }
+                    for(int p = 0; p < PPC; p++) {
+                        uint8_t column[2];
+                        pix[p] = axis_reader.data.range(BITS*p + 7, BITS*p).to_uint();
+                        line_buf.Insert(xb*PPC + p, pix[p], column);
+                        pix_u[p] = column[0];
+                    }
+                    for(int p = 0; p < PPC; p++) {
+                        const uint8_t pix_ul = (p == 0) ? last_u : pix_u[p - 1];
+                        const uint8_t pix_l  = (p == 0) ? last_l : pix[p - 1];
+                        pix_out.pix[p] = BayerLumaPix<FMT>(pix_ul, pix_u[p], pix_l, pix[p], xb*PPC + p, yi);
+                    }
+                    last_u = pix_u[PPC - 1];
+                    last_l = pix[PPC - 1];
                 }
 
                 // output
-                dst[xi + yi*WIDTH] = pix_gray;
+                dst[xb + yi*LINE_BEATS] = pix_out;
             }
 
-            // when WIDTH param set less than actual frame size
+            // when width param set less than actual frame size
             // wait for the last signal to be asserted
             while (!eol) {
                 #pragma HLS PIPELINE II=1
@@ -149,28 +748,41 @@ namespace hlsimproc {
         }
     }
 
-    template<uint32_t WIDTH, uint32_t HEIGHT>
-    inline void HlsImProc::GrayArray2AXIS(uint8_t* src, hls::stream<ImAxis<24> >& axis_dst) {
-        ImAxis<24> axis_writer; // for write AXI4-Stream
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_T>
+    inline void HlsImProc::GrayArray2AXIS(SRC_T src, hls::stream<ImAxis<24, PPC> >& axis_dst,
+                                          uint32_t width, uint32_t height) {
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        ImAxis<24, PPC> axis_writer; // for write AXI4-Stream
 
         // image proc loop
-        for(int yi = 0; yi < HEIGHT; yi++) {
-            for(int xi = 0; xi < WIDTH; xi++) {
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
                 #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
                 #pragma HLS LOOP_FLATTEN off
 
-                unsigned int pix_out = src[xi + yi*WIDTH];
-                axis_writer.data = pix_out << 16 | pix_out << 8 | pix_out;
+                const PixBeat<uint8_t, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                for(int p = 0; p < PPC; p++) {
+                    unsigned int pix_out = pix_in.pix[p];
+                    axis_writer.data.range(24*p + 23, 24*p) = pix_out << 16 | pix_out << 8 | pix_out;
+                }
 
                 // assert user signal at start of frame
-                if (xi == 0 && yi == 0) {
+                if (xb == 0 && yi == 0) {
                     axis_writer.user = 1;
                 }
                 else {
                     axis_writer.user = 0;
                 }
                 // assert last signal at end of line
-                if (xi == (WIDTH - 1)) {
+                if (xb == (line_beats - 1)) {
                     axis_writer.last = 1;
                 }
                 else {
@@ -183,365 +795,2127 @@ namespace hlsimproc {
         }
     }
 
-    template<uint32_t WIDTH, uint32_t HEIGHT>
-    inline void HlsImProc::GaussianBlur(uint8_t* src, uint8_t* dst) {
-        const int KERNEL_SIZE = 5;
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename DST_T>
+    inline void HlsImProc::Mem2GrayArray(const uint32_t* src_mem, DST_T dst, uint32_t stride,
+                                         uint32_t width, uint32_t height) {
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
 
-        uint8_t line_buf[KERNEL_SIZE][WIDTH];
-        uint8_t window_buf[KERNEL_SIZE][KERNEL_SIZE];
-
-        #pragma HLS ARRAY_RESHAPE variable=line_buf complete dim=1
-        #pragma HLS ARRAY_PARTITION variable=window_buf complete dim=0
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            const uint32_t* line_src = src_mem + yi*stride;
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
 
-        //-- 5x5 Gaussian kernel (8bit left shift)
-        const int GAUSS_KERNEL[KERNEL_SIZE][KERNEL_SIZE] = { {1,  4,  6,  4, 1},
-                                                             {4, 16, 24, 16, 4},
-                                                             {6, 24, 36, 24, 6},
-                                                             {4, 16, 24, 16, 4},
-                                                             {1,  4,  6,  4, 1} };
+                const ap_uint<24> pix_data = line_src[xi];
+                dst[xi + yi*WIDTH] = GrayPix(pix_data);
+            }
+        }
+    }
 
-        #pragma HLS ARRAY_PARTITION variable=GAUSS_KERNEL complete dim=0
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T>
+    inline void HlsImProc::GrayArray2Mem(SRC_T src, uint8_t* dst_mem, uint32_t stride,
+                                         uint32_t width, uint32_t height) {
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
 
         // image proc loop
-        for(int yi = 0; yi < HEIGHT; yi++) {
-            for(int xi = 0; xi < WIDTH; xi++) {
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            uint8_t* line_dst = dst_mem + yi*stride;
+            for(int xi = 0; xi < im_width; xi++) {
                 #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
                 #pragma HLS LOOP_FLATTEN off
 
-                //--- gaussian bler
-                int pix_gauss;
+                const uint8_t pix_in = src[xi + yi*WIDTH];
+                line_dst[xi] = pix_in;
+            }
+        }
+    }
 
-                //-- line buffer
-                for(int yl = 0; yl < KERNEL_SIZE - 1; yl++) {
-                    line_buf[yl][xi] = line_buf[yl + 1][xi];
-                }
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename DST_T>
+    inline void HlsImProc::Mem2GrayArrayStripe(const uint32_t* src_mem, DST_T dst, uint32_t stride, int32_t win_x,
+                                               uint32_t width, uint32_t height, uint32_t frame_width) {
+        // stripe size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
 
-                // write to line buffer
-                line_buf[KERNEL_SIZE - 1][xi] = src[xi + yi*WIDTH];
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            const uint32_t* line_src = src_mem + yi*stride;
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
 
-                //-- window buffer
-                for(int yw = 0; yw < KERNEL_SIZE; yw++) {
-                    for(int xw = 0; xw < KERNEL_SIZE - 1; xw++) {
-                        window_buf[yw][xw] = window_buf[yw][xw + 1];
-                    }
+                // position in the frame (left of the frame: the end of the previous line)
+                const int fx = win_x + xi;
+                if(0 <= fx) {
+                    const ap_uint<24> pix_data = line_src[fx];
+                    dst[xi + yi*WIDTH] = GrayPix(pix_data);
                 }
-
-                // write to window buffer
-                for(int yw = 0; yw < KERNEL_SIZE; yw++) {
-                    window_buf[yw][KERNEL_SIZE - 1] = line_buf[yw][xi];
+                else if(yi > 0) {
+                    const ap_uint<24> pix_data = line_src[int(frame_width) + fx - int(stride)];
+                    dst[xi + yi*WIDTH] = GrayPix(pix_data);
                 }
-
-                //-- convolution
-                pix_gauss = 0;
-                for(int yw = 0; yw < KERNEL_SIZE; yw++) {
-                    for(int xw = 0; xw < KERNEL_SIZE; xw++) {
-                        pix_gauss += window_buf[yw][xw] * GAUSS_KERNEL[yw][xw];
-                    }
+                else {
+                    dst[xi + yi*WIDTH] = 0;
                 }
-
-                // 8bit right shift
-                pix_gauss >>= 8;
-
-                // output
-                dst[xi + yi*WIDTH] = pix_gauss;
             }
         }
     }
 
-    template<uint32_t WIDTH, uint32_t HEIGHT>
-    inline void HlsImProc::Sobel(uint8_t* src, GradPix* dst) {
-        const int KERNEL_SIZE = 3;
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T>
+    inline void HlsImProc::GrayArray2MemStripe(SRC_T src, uint8_t* dst_mem, uint32_t stride, uint32_t roi_x, uint32_t roi_width,
+                                               uint32_t width, uint32_t height) {
+        // stripe size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
 
-        uint8_t line_buf[KERNEL_SIZE][WIDTH];
-        uint8_t window_buf[KERNEL_SIZE][KERNEL_SIZE];
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            uint8_t* line_dst = dst_mem + yi*stride;
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
 
-        #pragma HLS ARRAY_RESHAPE variable=line_buf complete dim=1
-        #pragma HLS ARRAY_PARTITION variable=window_buf complete dim=0
+                const uint8_t pix_in = src[xi + yi*WIDTH];
+                if(roi_x <= xi && xi < roi_x + roi_width) {
+                    line_dst[xi - roi_x] = pix_in;
+                }
+            }
+        }
+    }
 
-        //-- 3x3 Horizontal Sobel kernel
-        const int H_SOBEL_KERNEL[KERNEL_SIZE][KERNEL_SIZE] = {  { 1,  0, -1},
-                                                                { 2,  0, -2},
-                                                                { 1,  0, -1}   };
-        //-- 3x3 vertical Sobel kernel
-        const int V_SOBEL_KERNEL[KERNEL_SIZE][KERNEL_SIZE] = {  { 1,  2,  1},
-                                                                { 0,  0,  0},
-                                                                {-1, -2, -1}   };
+    template<uint32_t WIDTH, uint32_t HEIGHT, int BPP, int BEAT_W, typename SRC_T>
+    inline void HlsImProc::GrayArray2AXISPacked(SRC_T src, hls::stream<ImAxis<BEAT_W> >& axis_dst,
+                                                uint32_t width, uint32_t height) {
+        const int PIX_PER_BEAT = BEAT_W / BPP;
+        const int STRONG_CODE = (1 << BPP) - 1;
 
-        #pragma HLS ARRAY_PARTITION variable=H_SOBEL_KERNEL complete dim=0
-        #pragma HLS ARRAY_PARTITION variable=V_SOBEL_KERNEL complete dim=0
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        ImAxis<BEAT_W> axis_writer; // for write AXI4-Stream
+        ap_uint<BEAT_W> beat_data;
 
         // image proc loop
-        for(int yi = 0; yi < HEIGHT; yi++) {
-            for(int xi = 0; xi < WIDTH; xi++) {
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xi = 0; xi < im_width; xi++) {
                 #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
                 #pragma HLS LOOP_FLATTEN off
 
-                //--- sobel
-                int pix_sobel;
-                GradDir grad_sobel;
-
-                //-- line buffer
-                for(int yl = 0; yl < KERNEL_SIZE - 1; yl++) {
-                    line_buf[yl][xi] = line_buf[yl + 1][xi];
-                }
-                // write to line buffer
-                line_buf[KERNEL_SIZE - 1][xi] = src[xi + yi*WIDTH];
+                const uint8_t pix_in = src[xi + yi*WIDTH];
+                const int slot = xi % PIX_PER_BEAT;
 
-                //-- window buffer
-                for(int yw = 0; yw < KERNEL_SIZE; yw++) {
-                    for(int xw = 0; xw < KERNEL_SIZE - 1; xw++) {
-                        window_buf[yw][xw] = window_buf[yw][xw + 1];
-                    }
+                // code of the pixel
+                int code = 0;
+                if(pix_in == 0xFF) {
+                    code = STRONG_CODE;
                 }
-                // write to window buffer
-                for(int yw = 0; yw < KERNEL_SIZE; yw++) {
-                    window_buf[yw][KERNEL_SIZE - 1] = line_buf[yw][xi];
+                else if(BPP > 1 && pix_in != 0) {
+                    code = 1;
                 }
 
-                //-- convolution
-                int pix_h_sobel = 0;
-                int pix_v_sobel = 0;
-
-                // convolution using by holizonal kernel
-                for(int yw = 0; yw < KERNEL_SIZE; yw++) {
-                    for(int xw = 0; xw < KERNEL_SIZE; xw++) {
-                        pix_h_sobel += window_buf[yw][xw] * H_SOBEL_KERNEL[yw][xw];
-                    }
+                if(slot == 0) {
+                    beat_data = 0;
                 }
-
-                // convolution using by vertical kernel
-                for(int yw = 0; yw < KERNEL_SIZE; yw++) {
-                    for(int xw = 0; xw < KERNEL_SIZE; xw++) {
-                        pix_v_sobel += window_buf[yw][xw] * V_SOBEL_KERNEL[yw][xw];
-                    }
+                beat_data.range(BPP*slot + BPP - 1, BPP*slot) = code;
+
+                // output when the beat is full or at end of line
+                if(slot == PIX_PER_BEAT - 1 || xi == im_width - 1) {
+                    axis_writer.data = beat_data;
+                    axis_writer.user = (yi == 0 && xi < PIX_PER_BEAT);
+                    axis_writer.last = (xi == im_width - 1);
+                    axis_dst << axis_writer;
                 }
+            }
+        }
+    }
 
-                pix_sobel = hls::sqrt(float(pix_h_sobel * pix_h_sobel + pix_v_sobel * pix_v_sobel));
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T, typename GRAD_T>
+    inline void HlsImProc::EdgeArray2AXISSparse(SRC_T src, GRAD_T grad_src, hls::stream<ImAxis<32> >& axis_dst,
+                                                uint32_t width, uint32_t height) {
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
 
-                // to consider saturation
-                if(255 < pix_sobel) {
-                    pix_sobel = 255;
-                }
+        // directions of the two lines above and the two pixels left of the current pixel
+        LineBuffer<ap_uint<2>, 3, WIDTH> line_buf;
+        ap_uint<2> dir_left1 = 0;
+        ap_uint<2> dir_left2 = 0;
 
-                // evaluate gradient direction
-                int t_int;
-                if(pix_h_sobel != 0) {
-                    t_int = pix_v_sobel * 256 / pix_h_sobel;
-                }
-                else {
-                    t_int = 0x7FFFFFFF;
-                }
+        ImAxis<32> axis_writer; // for write AXI4-Stream
+        uint32_t num_edges = 0;
+        bool sof = true;
 
-                // 112.5° ~ 157.5° (tan 112.5° ~= -2.4142, tan 157.5° ~= -0.4142)
-                if(-618 < t_int && t_int <= -106) {
-                    grad_sobel = DIR_135;
-                }
-                // -22.5° ~ 22.5° (tan -22.5° ~= -0.4142, tan 22.5° = 0.4142)
-                else if(-106 < t_int && t_int <= 106) {
-                    grad_sobel = DIR_0;
-                }
-                // 22.5° ~ 67.5° (tan 22.5° ~= 0.4142, tan 67.5° = 2.4142)
-                else if(106 < t_int && t_int < 618) {
-                    grad_sobel = DIR_45;
-                }
-                // 67.5° ~ 112.5° (to inf)
-                else {
-                    grad_sobel = DIR_90;
-                }
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
 
-                // output
-                if((KERNEL_SIZE < xi && xi < WIDTH - KERNEL_SIZE) &&
-                   (KERNEL_SIZE < yi && yi < HEIGHT - KERNEL_SIZE)) {
-                    dst[xi + yi*WIDTH].value = pix_sobel;
-                    dst[xi + yi*WIDTH].grad  = grad_sobel;
+                const uint8_t pix_in = src[xi + yi*WIDTH];
+                const GradPix grad_in = grad_src[xi + yi*WIDTH];
+
+                //-- line buffer (rows above the frame are cleared at the first line)
+                ap_uint<2> column[3];
+                if(xi == 0) {
+                    line_buf.NextLine(yi == 0);
                 }
-                else {
-                    dst[xi + yi*WIDTH].value = 0;
-                    dst[xi + yi*WIDTH].grad  = grad_sobel;
+                line_buf.Insert(xi, grad_in.range(9, 8), column);
+                const ap_uint<2> dir_up2 = column[0];
+
+                // direction at (xi - 2, yi - 2)
+                const ap_uint<2> dir = dir_left2;
+                dir_left2 = dir_left1;
+                dir_left1 = dir_up2;
+
+                // output of the edge pixel
+                if(pix_in == 0xFF) {
+                    axis_writer.data = 0;
+                    axis_writer.data.range(11, 0)  = xi;
+                    axis_writer.data.range(23, 12) = yi;
+                    axis_writer.data.range(25, 24) = dir;
+                    axis_writer.user = sof;
+                    axis_writer.last = 0;
+                    axis_dst << axis_writer;
+                    sof = false;
+                    num_edges++;
                 }
             }
         }
+
+        // end of frame (number of edge pixels)
+        axis_writer.data = 0x80000000u | num_edges;
+        axis_writer.user = sof;
+        axis_writer.last = 1;
+        axis_dst << axis_writer;
     }
 
-    template<uint32_t WIDTH, uint32_t HEIGHT>
-    inline void HlsImProc::NonMaxSuppression(GradPix* src, uint8_t* dst) {
-        const int WINDOW_SIZE = 3;
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T>
+    inline void HlsImProc::GradArray2AXIS(SRC_T xy_src, hls::stream<ImAxis<32> >& axis_dst,
+                                          uint32_t width, uint32_t height) {
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
 
-        GradPix line_buf[WINDOW_SIZE][WIDTH];
-        GradPix window_buf[WINDOW_SIZE][WINDOW_SIZE];
+        // gradients of the two lines above and the two pixels left of the current pixel
+        LineBuffer<GradXY, 3, WIDTH> line_buf;
+        GradXY xy_left1 = 0;
+        GradXY xy_left2 = 0;
 
-        #pragma HLS ARRAY_RESHAPE variable=line_buf complete dim=1
-        #pragma HLS ARRAY_PARTITION variable=window_buf complete dim=0
+        ImAxis<32> axis_writer; // for write AXI4-Stream
 
         // image proc loop
-        for(int yi = 0; yi < HEIGHT; yi++) {
-            for(int xi = 0; xi < WIDTH; xi++) {
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xi = 0; xi < im_width; xi++) {
                 #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
                 #pragma HLS LOOP_FLATTEN off
 
-                //--- non-maximum suppression
-                uint8_t value_nms;
-                GradDir grad_nms;
+                const GradXY xy_in = xy_src[xi + yi*WIDTH];
 
-                //-- line buffer
-                for(int yl = 0; yl < WINDOW_SIZE - 1; yl++) {
-                    line_buf[yl][xi] = line_buf[yl + 1][xi];
+                //-- line buffer (rows above the frame are cleared at the first line)
+                GradXY column[3];
+                if(xi == 0) {
+                    line_buf.NextLine(yi == 0);
                 }
-                // write to line buffer
-                line_buf[WINDOW_SIZE - 1][xi] = src[xi + yi*WIDTH];
+                line_buf.Insert(xi, xy_in, column);
+
+                // gradient at (xi - 2, yi - 2)
+                const GradXY xy_out = xy_left2;
+                xy_left2 = xy_left1;
+                xy_left1 = column[0];
+
+                // output (sign extended to 16 bits)
+                axis_writer.data.range(15, 0)  = GradX(xy_out);
+                axis_writer.data.range(31, 16) = GradY(xy_out);
+                axis_writer.user = (xi == 0 && yi == 0);
+                axis_writer.last = (xi == im_width - 1);
+                axis_dst << axis_writer;
+            }
+        }
+    }
 
-                //-- window buffer
-                for(int yw = 0; yw < WINDOW_SIZE; yw++) {
-                    for(int xw = 0; xw < WINDOW_SIZE - 1; xw++) {
-                        window_buf[yw][xw] = window_buf[yw][xw + 1];
-                    }
-                }
-                // write to window buffer
-                for(int yw = 0; yw < WINDOW_SIZE; yw++) {
-                    window_buf[yw][WINDOW_SIZE - 1] = line_buf[yw][xi];
-                }
+    template<uint32_t WIDTH, uint32_t HEIGHT, int NUM_PEAKS, int THETA_BINS, int RHO_SHIFT, typename SRC_T, typename GRAD_T>
+    inline void HlsImProc::HoughAccumulate(SRC_T src, GRAD_T grad_src, HoughAccumulator<WIDTH, HEIGHT, THETA_BINS, RHO_SHIFT>& acc,
+                                           hls::stream<ImAxis<32> >& axis_dst, uint32_t width, uint32_t height) {
+        typedef HoughAccumulator<WIDTH, HEIGHT, THETA_BINS, RHO_SHIFT> Acc;
+        const int SECTOR_BINS = Acc::SECTOR_BINS;
+        const int RHO_BINS = Acc::RHO_BINS;
+        static_assert(THETA_BINS % 4 == 0 && THETA_BINS <= 256, "THETA_BINS must be a multiple of 4 up to 256");
+        static_assert(RHO_BINS <= 4096, "rho bins must fit in 12 bits (raise RHO_SHIFT)");
+
+        #pragma HLS ARRAY_PARTITION variable=acc.bins complete dim=1
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        // directions of the two lines above and the two pixels left of the current pixel
+        LineBuffer<ap_uint<2>, 3, WIDTH> line_buf;
+        ap_uint<2> dir_left1 = 0;
+        ap_uint<2> dir_left2 = 0;
+
+        // count of the last cell of each bank, written to the bank when the cell changes
+        // (no read-modify-write of the same cell in consecutive beats)
+        int last_addr[SECTOR_BINS];
+        ap_uint<16> last_acc[SECTOR_BINS];
+        #pragma HLS ARRAY_PARTITION variable=last_addr complete dim=1
+        #pragma HLS ARRAY_PARTITION variable=last_acc complete dim=1
+        for(int k = 0; k < SECTOR_BINS; k++) {
+            last_addr[k] = 0;
+            last_acc[k] = 0;
+        }
 
-                value_nms = window_buf[WINDOW_SIZE / 2][WINDOW_SIZE / 2].value;
-                grad_nms = window_buf[WINDOW_SIZE / 2][WINDOW_SIZE / 2].grad;
-                // grad 0° -> left, right
-                if(grad_nms == DIR_0) {
-                    if(value_nms < window_buf[WINDOW_SIZE / 2][0].value ||
-                       value_nms < window_buf[WINDOW_SIZE / 2][WINDOW_SIZE - 1].value) {
-                        value_nms = 0;
-                    }
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+                #pragma HLS DEPENDENCE variable=acc.bins inter false
+
+                const uint8_t pix_in = src[xi + yi*WIDTH];
+                const GradPix grad_in = grad_src[xi + yi*WIDTH];
+
+                //-- line buffer (rows above the frame are cleared at the first line)
+                ap_uint<2> column[3];
+                if(xi == 0) {
+                    line_buf.NextLine(yi == 0);
                 }
-                // grad 45° -> upper left, bottom right
-                else if(grad_nms == DIR_45) {
-                    if(value_nms < window_buf[0][0].value ||
-                       value_nms < window_buf[WINDOW_SIZE - 1][WINDOW_SIZE - 1].value) {
-                        value_nms = 0;
+                line_buf.Insert(xi, grad_in.range(9, 8), column);
+                const ap_uint<2> dir_up2 = column[0];
+
+                // direction at (xi - 2, yi - 2)
+                const int dir = dir_left2;
+                dir_left2 = dir_left1;
+                dir_left1 = dir_up2;
+
+                //-- votes of the edge pixel (one angle of its sector in each bank)
+                if(pix_in == 0xFF) {
+                    for(int k = 0; k < SECTOR_BINS; k++) {
+                        const int t = (dir*SECTOR_BINS + k + THETA_BINS - SECTOR_BINS / 2) % THETA_BINS;
+                        const int rho = (xi * HoughTrig<THETA_BINS>::COS[t] + yi * HoughTrig<THETA_BINS>::SIN[t]) >> 14;
+                        const int addr = dir*RHO_BINS + ((rho + int(WIDTH)) >> RHO_SHIFT);
+                        if(addr == last_addr[k]) {
+                            last_acc[k]++;
+                        }
+                        else {
+                            acc.bins[k][last_addr[k]] = last_acc[k];
+                            last_addr[k] = addr;
+                            last_acc[k] = acc.bins[k][addr] + 1;
+                        }
                     }
                 }
-                // grad 90° -> upper, bottom
-                else if(grad_nms == DIR_90) {
-                    if(value_nms < window_buf[0][WINDOW_SIZE - 1].value ||
-                       value_nms < window_buf[WINDOW_SIZE - 1][WINDOW_SIZE / 2].value) {
-                        value_nms = 0;
-                    }
+            }
+        }
+
+        // flush the last cells
+        for(int k = 0; k < SECTOR_BINS; k++) {
+            acc.bins[k][last_addr[k]] = last_acc[k];
+        }
+
+        //-- peaks: the largest angle of each sector and rho is inserted into the sorted peaks,
+        //   and the cells are cleared for the next frame
+        ap_uint<16> peak_votes[NUM_PEAKS];
+        int peak_rho[NUM_PEAKS];
+        int peak_theta[NUM_PEAKS];
+        #pragma HLS ARRAY_PARTITION variable=peak_votes complete dim=1
+        #pragma HLS ARRAY_PARTITION variable=peak_rho complete dim=1
+        #pragma HLS ARRAY_PARTITION variable=peak_theta complete dim=1
+        for(int i = 0; i < NUM_PEAKS; i++) {
+            peak_votes[i] = 0;
+            peak_rho[i] = 0;
+            peak_theta[i] = 0;
+        }
+
+        int sector = 0;
+        int rho_bin = 0;
+        for(int addr = 0; addr < 4 * RHO_BINS; addr++) {
+            #pragma HLS PIPELINE II=1
+
+            ap_uint<16> votes = acc.bins[0][addr];
+            int best_k = 0;
+            for(int k = 1; k < SECTOR_BINS; k++) {
+                if(acc.bins[k][addr] > votes) {
+                    votes = acc.bins[k][addr];
+                    best_k = k;
                 }
-                // grad 135° -> bottom left, upper right
-                else if(grad_nms == DIR_135) {
-                    if(value_nms < window_buf[WINDOW_SIZE - 1][0].value ||
-                       value_nms < window_buf[0][WINDOW_SIZE - 1].value) {
-                        value_nms = 0;
+            }
+            for(int k = 0; k < SECTOR_BINS; k++) {
+                acc.bins[k][addr] = 0;
+            }
+            const int theta = (sector*SECTOR_BINS + best_k + THETA_BINS - SECTOR_BINS / 2) % THETA_BINS;
+
+            // insertion from the smallest peak on (the earlier of two equal cells stays in front)
+            for(int i = NUM_PEAKS - 1; i >= 0; i--) {
+                if(votes > peak_votes[i]) {
+                    if(i + 1 < NUM_PEAKS) {
+                        peak_votes[i + 1] = peak_votes[i];
+                        peak_rho[i + 1]   = peak_rho[i];
+                        peak_theta[i + 1] = peak_theta[i];
+                    }
+                    if(i == 0 || votes <= peak_votes[i - 1]) {
+                        peak_votes[i] = votes;
+                        peak_rho[i]   = rho_bin;
+                        peak_theta[i] = theta;
                     }
                 }
+            }
 
-                // output
-                if((WINDOW_SIZE < xi && xi < WIDTH - WINDOW_SIZE) &&
-                   (WINDOW_SIZE < yi && yi < HEIGHT - WINDOW_SIZE)) {
-                    dst[xi + yi*WIDTH] = value_nms;
+            if(rho_bin == RHO_BINS - 1) {
+                sector++;
+                rho_bin = 0;
+            }
+            else {
+                rho_bin++;
+            }
+        }
+
+        // output
+        ImAxis<32> axis_writer; // for write AXI4-Stream
+        for(int i = 0; i < NUM_PEAKS; i++) {
+            #pragma HLS PIPELINE II=1
+            axis_writer.data = 0;
+            axis_writer.data.range(11, 0)  = peak_rho[i];
+            axis_writer.data.range(19, 12) = peak_theta[i];
+            axis_writer.data.range(31, 20) = (peak_votes[i] > 4095) ? 4095 : peak_votes[i].to_uint();
+            axis_writer.user = (i == 0);
+            axis_writer.last = (i == NUM_PEAKS - 1);
+            axis_dst << axis_writer;
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int D, int PPC, typename SRC_S, typename DST_S>
+    inline void HlsImProc::AXISInMonitor(SRC_S& axis_src, DST_S& axis_dst,
+                                         PerfCounters& perf, uint32_t width, uint32_t height) {
+        const int FRAME_BEATS = WIDTH / PPC * HEIGHT;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const uint32_t line_beats = im_width / PPC;
+
+        uint32_t sof_discarded = perf.sof_discarded;
+        uint32_t short_lines   = perf.short_lines;
+        uint32_t long_lines    = perf.long_lines;
+        uint32_t in_stalls     = perf.in_stalls;
+
+        ImAxis<D, PPC> axis_reader;
+        bool sof = false;    // Start of Frame has been seen
+        uint32_t yi = 0;     // lines closed by the last signal
+        uint32_t xb = 0;     // beats of the current line
+
+        while(yi < im_height) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=FRAME_BEATS max=FRAME_BEATS
+
+            if(axis_src.read_nb(axis_reader)) {
+                if(!sof && !axis_reader.user.to_int()) {
+                    // wait for the user signal to be asserted
+                    sof_discarded++;
                 }
                 else {
-                    dst[xi + yi*WIDTH] = 0;
+                    sof = true;
+                    axis_dst.write(axis_reader);
+                    xb++;
+                    if(axis_reader.last.to_int()) {
+                        if(xb < line_beats) {
+                            short_lines++;
+                        }
+                        else if(xb > line_beats) {
+                            long_lines++;
+                        }
+                        xb = 0;
+                        yi++;
+                    }
                 }
             }
+            else if(sof) {
+                in_stalls++;
+            }
         }
+
+        perf.sof_discarded = sof_discarded;
+        perf.short_lines   = short_lines;
+        perf.long_lines    = long_lines;
+        perf.in_stalls     = in_stalls;
     }
 
-    template<uint32_t WIDTH, uint32_t HEIGHT>
-    inline void HlsImProc::HystThreshold(uint8_t* src, uint8_t* dst, uint8_t hthr, uint8_t lthr) {
-        // image proc loop
-        for(int yi = 0; yi < HEIGHT; yi++) {
-            for(int xi = 0; xi < WIDTH; xi++) {
-                #pragma HLS PIPELINE II=1
-                #pragma HLS LOOP_FLATTEN off
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_S, typename DST_S>
+    inline void HlsImProc::AXISOutMonitor(SRC_S& axis_src, DST_S& axis_dst,
+                                          PerfCounters& perf, uint32_t width, uint32_t height) {
+        const int FRAME_BEATS = WIDTH / PPC * HEIGHT;
 
-                //--- hysteresis threshold
-                int pix_hyst;
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const uint32_t frame_beats = im_width / PPC * im_height;
 
-                if(src[xi + yi*WIDTH] < lthr) {
-                    pix_hyst = 0;
+        uint32_t out_stalls  = perf.out_stalls;
+        uint32_t edge_pixels = 0;
+
+        ImAxis<24, PPC> axis_reader;
+        bool valid = false;  // axis_reader holds a beat that has not been written
+        uint32_t beats = 0;
+
+        while(beats < frame_beats) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=FRAME_BEATS max=FRAME_BEATS
+
+            if(!valid) {
+                valid = axis_src.read_nb(axis_reader);
+                if(valid) {
+                    for(int p = 0; p < PPC; p++) {
+                        if(axis_reader.data.range(24*p + 7, 24*p) == 0xFF) {
+                            edge_pixels++;
+                        }
+                    }
                 }
-                else if(src[xi + yi*WIDTH] > hthr) {
-                    pix_hyst = 255;
+            }
+            if(valid) {
+                if(axis_dst.write_nb(axis_reader)) {
+                    valid = false;
+                    beats++;
                 }
                 else {
-                    pix_hyst = 1;
+                    out_stalls++;
                 }
-
-                // output
-                dst[xi + yi*WIDTH] = pix_hyst;
             }
         }
-    }
 
-    template<uint32_t WIDTH, uint32_t HEIGHT>
-    inline void HlsImProc::HystThresholdComp(uint8_t* src, uint8_t* dst) {
-        const int WINDOW_SIZE = 3;
+        perf.frames++;
+        perf.out_stalls  = out_stalls;
+        perf.edge_pixels = edge_pixels;
+    }
 
-        uint8_t line_buf[WINDOW_SIZE][WIDTH];
-        uint8_t window_buf[WINDOW_SIZE][WINDOW_SIZE];
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename T, int PPC, typename SRC_T, typename DST1_T, typename DST2_T>
+    inline void HlsImProc::Duplicate(SRC_T src, DST1_T dst1, DST2_T dst2, uint32_t width, uint32_t height) {
+        const int LINE_BEATS = WIDTH / PPC;
 
-        #pragma HLS ARRAY_RESHAPE variable=line_buf complete dim=1
-        #pragma HLS ARRAY_PARTITION variable=window_buf complete dim=0
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
 
         // image proc loop
-        for(int yi = 0; yi < HEIGHT; yi++) {
-            for(int xi = 0; xi < WIDTH; xi++) {
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
                 #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
                 #pragma HLS LOOP_FLATTEN off
 
-                //--- non-maximum suppression
-                uint8_t pix_hyst = 0;
+                const PixBeat<T, PPC> beat = src[xb + yi*LINE_BEATS];
+                dst1[xb + yi*LINE_BEATS] = beat;
+                dst2[xb + yi*LINE_BEATS] = beat;
+            }
+        }
+    }
 
-                //-- line buffer
-                for(int yl = 0; yl < WINDOW_SIZE - 1; yl++) {
-                    line_buf[yl][xi] = line_buf[yl + 1][xi];
-                }
-                // write to line buffer
-                line_buf[WINDOW_SIZE - 1][xi] = src[xi + yi*WIDTH];
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T, typename DST_T, typename HALF_T>
+    inline void HlsImProc::Decimate(SRC_T src, DST_T dst, HALF_T dst_half, uint32_t width, uint32_t height) {
+        static_assert(WIDTH % 2 == 0, "WIDTH must be even");
+        const int HALF_WIDTH = WIDTH / 2;
 
-                //-- window buffer
-                for(int yw = 0; yw < WINDOW_SIZE; yw++) {
-                    for(int xw = 0; xw < WINDOW_SIZE - 1; xw++) {
-                        window_buf[yw][xw] = window_buf[yw][xw + 1];
-                    }
-                }
-                // write to window buffer
-                for(int yw = 0; yw < WINDOW_SIZE; yw++) {
-                    window_buf[yw][WINDOW_SIZE - 1] = line_buf[yw][xi];
-                }
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        // size of the half resolution frame (an odd last column/line is dropped)
+        const uint32_t half_width  = im_width / 2;
+        const uint32_t half_height = im_height / 2;
 
-                //-- comparison operation
-                for(int yw = 0; yw < WINDOW_SIZE; yw++) {
-                    for(int xw = 0; xw < WINDOW_SIZE; xw++) {
-                        if(window_buf[WINDOW_SIZE / 2][WINDOW_SIZE / 2] != 0) {
-                            if(window_buf[yw][xw] == 0xFF) {
-                                pix_hyst = 0xFF;
-                            }
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+
+                const uint8_t pix_in = src[xi + yi*WIDTH];
+                dst[xi + yi*WIDTH] = pix_in;
+
+                // one pixel of each 2x2 block
+                const int hx = xi / 2;
+                const int hy = yi / 2;
+                if(xi % 2 == 0 && yi % 2 == 0 && hx < half_width && hy < half_height) {
+                    dst_half[hx + hy*HALF_WIDTH] = pix_in;
+                }
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, uint32_t TILE_W, uint32_t TILE_H, typename SRC_T, typename DST_T>
+    inline void HlsImProc::GrayTileChange(SRC_T src, DST_T dst,
+                                          uint32_t tile_sig[((WIDTH + TILE_W - 1) / TILE_W) * ((HEIGHT + TILE_H - 1) / TILE_H)],
+                                          uint8_t tile_changed[((WIDTH + TILE_W - 1) / TILE_W) * ((HEIGHT + TILE_H - 1) / TILE_H)],
+                                          uint32_t width, uint32_t height) {
+        const int TILES_X = (WIDTH + TILE_W - 1) / TILE_W;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const uint32_t tiles_x = (im_width + TILE_W - 1) / TILE_W;
+
+        // CRC of the tiles of the current tile row (saved at the end of each tile line)
+        // and of the current tile
+        uint32_t crc_buf[TILES_X];
+        uint32_t crc = 0xFFFFFFFFu;
+
+        int ty = 0; // tile row
+        int ry = 0; // line in the tile row
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            int tx = 0; // tile column
+            int rx = 0; // column in the tile
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+
+                const PixBeat<uint8_t, 1> pix_in = src[xi + yi*WIDTH];
+                dst[xi + yi*WIDTH] = pix_in;
+
+                //-- CRC of the tile (started at its first pixel, resumed at the first pixel of its other lines)
+                if(rx == 0) {
+                    crc = (ry == 0) ? 0xFFFFFFFFu : crc_buf[tx];
+                }
+                crc = Crc32Byte(crc, pix_in.pix[0]);
+
+                // end of the tile line: save the CRC, or compare it at the last pixel of the tile
+                if(rx == TILE_W - 1 || xi == im_width - 1) {
+                    crc_buf[tx] = crc;
+                    if(ry == TILE_H - 1 || yi == im_height - 1) {
+                        const int ti = tx + ty*tiles_x;
+                        const uint32_t sig = ~crc;
+                        tile_changed[ti] = (tile_sig[ti] != sig);
+                        tile_sig[ti] = sig;
+                    }
+                    tx++;
+                    rx = 0;
+                }
+                else {
+                    rx++;
+                }
+            }
+            if(ry == TILE_H - 1) {
+                ty++;
+                ry = 0;
+            }
+            else {
+                ry++;
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, int KSIZE, int SIGMA_X100, typename SRC_T, typename DST_T>
+    inline void HlsImProc::GaussianBlur(SRC_T src, DST_T dst, uint32_t width, uint32_t height) {
+        const int KERNEL_SIZE = KSIZE;
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        LineBuffer<uint8_t, KERNEL_SIZE, WIDTH, PPC> line_buf;
+        SlidingWindow<ap_uint<16>, KERNEL_SIZE, PPC, 1> window_buf; // vertical sums of the columns
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
+                #pragma HLS LOOP_FLATTEN off
+
+                //--- gaussian bler
+                const PixBeat<uint8_t, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                PixBeat<uint8_t, PPC> pix_out;
+
+                //-- line buffer (rows above the frame are cleared at the first line) and
+                //   window buffer (columns left of the frame are cleared at the first pixel)
+                if(xb == 0) {
+                    line_buf.NextLine(yi == 0);
+                }
+                window_buf.Shift(xb == 0 && yi == 0);
+
+                // write the vertical pass of the new columns to window buffer
+                for(int p = 0; p < PPC; p++) {
+                    uint8_t column[KERNEL_SIZE];
+                    line_buf.Insert(xb*PPC + p, pix_in.pix[p], column);
+                    const ap_uint<16> vsum_col[1] = { GaussColumn<KSIZE, SIGMA_X100>(column) };
+                    window_buf.Insert(p, vsum_col);
+                }
+
+                // output (horizontal pass)
+                for(int p = 0; p < PPC; p++) {
+                    ap_uint<16> vsum[1][KERNEL_SIZE];
+                    window_buf.Get(p, vsum);
+                    pix_out.pix[p] = GaussRow<KSIZE, SIGMA_X100>(vsum[0]);
+                }
+                dst[xb + yi*LINE_BEATS] = pix_out;
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, MagMode MAG, typename SRC_T, typename DST_T>
+    inline void HlsImProc::Sobel(SRC_T src, DST_T dst, uint32_t width, uint32_t height) {
+        const int KERNEL_SIZE = 3;
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        LineBuffer<uint8_t, KERNEL_SIZE, WIDTH, PPC> line_buf;
+        SlidingWindow<uint8_t, KERNEL_SIZE, PPC> window_buf;
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
+                #pragma HLS LOOP_FLATTEN off
+
+                //--- sobel
+                const PixBeat<uint8_t, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                PixBeat<GradPix, PPC> pix_out;
+
+                //-- line buffer (rows above the frame are cleared at the first line) and
+                //   window buffer (columns left of the frame are cleared at the first pixel)
+                if(xb == 0) {
+                    line_buf.NextLine(yi == 0);
+                }
+                window_buf.Shift(xb == 0 && yi == 0);
+                for(int p = 0; p < PPC; p++) {
+                    uint8_t column[KERNEL_SIZE];
+                    line_buf.Insert(xb*PPC + p, pix_in.pix[p], column);
+                    window_buf.Insert(p, column);
+                }
+
+                // output
+                for(int p = 0; p < PPC; p++) {
+                    const int xi = xb*PPC + p;
+                    uint8_t pix_window[KERNEL_SIZE][KERNEL_SIZE];
+                    window_buf.Get(p, pix_window);
+                    pix_out.pix[p] = SobelPix<MAG>(pix_window);
+                    if(!((KERNEL_SIZE < xi && xi < im_width - KERNEL_SIZE) &&
+                         (KERNEL_SIZE < yi && yi < im_height - KERNEL_SIZE))) {
+                        pix_out.pix[p].range(7, 0) = 0;
+                    }
+                }
+                dst[xb + yi*LINE_BEATS] = pix_out;
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, MagMode MAG, typename SRC_T, typename DST_T, typename XY_T>
+    inline void HlsImProc::SobelXY(SRC_T src, DST_T dst, XY_T xy_dst, uint32_t width, uint32_t height) {
+        const int KERNEL_SIZE = 3;
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        LineBuffer<uint8_t, KERNEL_SIZE, WIDTH, PPC> line_buf;
+        SlidingWindow<uint8_t, KERNEL_SIZE, PPC> window_buf;
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
+                #pragma HLS LOOP_FLATTEN off
+
+                //--- sobel
+                const PixBeat<uint8_t, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                PixBeat<GradPix, PPC> pix_out;
+                PixBeat<GradXY, PPC> xy_out;
+
+                //-- line buffer (rows above the frame are cleared at the first line) and
+                //   window buffer (columns left of the frame are cleared at the first pixel)
+                if(xb == 0) {
+                    line_buf.NextLine(yi == 0);
+                }
+                window_buf.Shift(xb == 0 && yi == 0);
+                for(int p = 0; p < PPC; p++) {
+                    uint8_t column[KERNEL_SIZE];
+                    line_buf.Insert(xb*PPC + p, pix_in.pix[p], column);
+                    window_buf.Insert(p, column);
+                }
+
+                // output
+                for(int p = 0; p < PPC; p++) {
+                    const int xi = xb*PPC + p;
+                    uint8_t pix_window[KERNEL_SIZE][KERNEL_SIZE];
+                    window_buf.Get(p, pix_window);
+                    pix_out.pix[p] = SobelPix<MAG>(pix_window);
+                    ap_int<11> pix_h_sobel;
+                    ap_int<11> pix_v_sobel;
+                    SobelConv(pix_window, pix_h_sobel, pix_v_sobel);
+                    xy_out.pix[p] = MakeGradXY(pix_h_sobel, pix_v_sobel);
+                    if(!((KERNEL_SIZE < xi && xi < im_width - KERNEL_SIZE) &&
+                         (KERNEL_SIZE < yi && yi < im_height - KERNEL_SIZE))) {
+                        pix_out.pix[p].range(7, 0) = 0;
+                        xy_out.pix[p] = 0;
+                    }
+                }
+                dst[xb + yi*LINE_BEATS] = pix_out;
+                xy_dst[xb + yi*LINE_BEATS] = xy_out;
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_T, typename DST_T>
+    inline void HlsImProc::NonMaxSuppression(SRC_T src, DST_T dst, uint32_t width, uint32_t height) {
+        const int WINDOW_SIZE = 3;
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        LineBuffer<GradPix, WINDOW_SIZE, WIDTH, PPC> line_buf; // zero is MakeGradPix(0, DIR_0)
+        SlidingWindow<GradPix, WINDOW_SIZE, PPC> window_buf;
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
+                #pragma HLS LOOP_FLATTEN off
+
+                //--- non-maximum suppression
+                const PixBeat<GradPix, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                PixBeat<uint8_t, PPC> pix_out;
+
+                //-- line buffer (rows above the frame are cleared at the first line) and
+                //   window buffer (columns left of the frame are cleared at the first pixel)
+                if(xb == 0) {
+                    line_buf.NextLine(yi == 0);
+                }
+                window_buf.Shift(xb == 0 && yi == 0);
+                for(int p = 0; p < PPC; p++) {
+                    GradPix column[WINDOW_SIZE];
+                    line_buf.Insert(xb*PPC + p, pix_in.pix[p], column);
+                    window_buf.Insert(p, column);
+                }
+
+                // output
+                for(int p = 0; p < PPC; p++) {
+                    const int xi = xb*PPC + p;
+                    if((WINDOW_SIZE < xi && xi < im_width - WINDOW_SIZE) &&
+                       (WINDOW_SIZE < yi && yi < im_height - WINDOW_SIZE)) {
+                        GradPix pix_window[WINDOW_SIZE][WINDOW_SIZE];
+                        window_buf.Get(p, pix_window);
+                        pix_out.pix[p] = NonMaxSuppressionPix(pix_window);
+                    }
+                    else {
+                        pix_out.pix[p] = 0;
+                    }
+                }
+                dst[xb + yi*LINE_BEATS] = pix_out;
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_T, typename DST_T>
+    inline void HlsImProc::HystThreshold(SRC_T src, DST_T dst, uint8_t hthr, uint8_t lthr,
+                                         uint32_t width, uint32_t height) {
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
+                #pragma HLS LOOP_FLATTEN off
+
+                //--- hysteresis threshold
+                const PixBeat<uint8_t, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                PixBeat<uint8_t, PPC> pix_out;
+                for(int p = 0; p < PPC; p++) {
+                    pix_out.pix[p] = HystThresholdPix(pix_in.pix[p], hthr, lthr);
+                }
+
+                // output
+                dst[xb + yi*LINE_BEATS] = pix_out;
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_T, typename DST_T>
+    inline void HlsImProc::HystThresholdAdaptive(SRC_T src, DST_T dst, HystHistogram<PPC>& hist,
+                                                 uint8_t hthr, uint8_t lthr, bool adaptive,
+                                                 uint8_t hist_pct, uint8_t hist_ratio, uint32_t padding_size,
+                                                 uint32_t width, uint32_t height) {
+        const int NUM_BINS = 256;
+        const int LINE_BEATS = WIDTH / PPC;
+
+        #pragma HLS ARRAY_PARTITION variable=hist.bins complete dim=1
+        #pragma HLS ARRAY_PARTITION variable=hist.bins complete dim=2
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        // bank built from this frame and bank of the previous frame
+        const int bank = hist.bank;
+        const int prev = 1 - bank;
+
+        // thresholds of the previous frame are derived one bin per beat in the first
+        // NUM_BINS beats, where the rows are zero padded, and used from then on; the bins the
+        // padded rows ((padding_size + 1) * line_beats beats) do not cover are derived before
+        // the first beat, so no row after them uses the thresholds of two frames back
+        const uint32_t padded_beats = (padding_size + 1) * line_beats;
+        const int lead_bins = (padded_beats < NUM_BINS) ? NUM_BINS - padded_beats : 0;
+        const bool use_hist = adaptive && hist.valid;
+        uint8_t cur_hthr = use_hist ? hist.hthr : hthr;
+        uint8_t cur_lthr = use_hist ? hist.lthr : lthr;
+
+        const uint32_t prev_count = hist.count[prev];
+        const uint32_t target = (uint64_t(prev_count) * hist_pct) >> 8;
+        uint32_t cum = 0;
+        bool found = (prev_count == 0); // no non-zero pixel keeps the thresholds as they are
+        int bin = 1;                    // bin 0 (suppressed pixels) is not counted
+
+        // count of the last bin of each lane, written to the bank when the bin changes
+        // (no read-modify-write of the same bin in consecutive beats)
+        int last_bin[PPC];
+        uint32_t last_acc[PPC];
+        for(int p = 0; p < PPC; p++) {
+            last_bin[p] = 0;
+            last_acc[p] = 0;
+        }
+        uint32_t count = 0;
+
+        // bins the padded rows do not cover (narrow frames only)
+        for(; bin <= lead_bins && bin < NUM_BINS; bin++) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=0 max=0
+            HystHistogramBin(hist, prev, bin, target, hist_ratio, cum, found);
+        }
+        if(bin == NUM_BINS && adaptive && hist.valid) {
+            cur_hthr = hist.hthr;
+            cur_lthr = hist.lthr;
+        }
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
+                #pragma HLS LOOP_FLATTEN off
+                #pragma HLS DEPENDENCE variable=hist.bins inter false
+
+                //-- thresholds of the previous frame (one bin of the other bank per beat)
+                if(bin < NUM_BINS) {
+                    HystHistogramBin(hist, prev, bin, target, hist_ratio, cum, found);
+                    bin++;
+                    if(bin == NUM_BINS && adaptive && hist.valid) {
+                        cur_hthr = hist.hthr;
+                        cur_lthr = hist.lthr;
+                    }
+                }
+
+                //--- hysteresis threshold
+                const PixBeat<uint8_t, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                PixBeat<uint8_t, PPC> pix_out;
+                for(int p = 0; p < PPC; p++) {
+                    const uint8_t pix = pix_in.pix[p];
+                    pix_out.pix[p] = HystThresholdPix(pix, cur_hthr, cur_lthr);
+
+                    //-- histogram of this frame
+                    if(pix != 0) {
+                        count++;
+                        if(pix == last_bin[p]) {
+                            last_acc[p]++;
+                        }
+                        else {
+                            hist.bins[bank][p][last_bin[p]] = last_acc[p];
+                            last_bin[p] = pix;
+                            last_acc[p] = hist.bins[bank][p][pix] + 1;
                         }
                     }
                 }
 
                 // output
-                dst[xi + yi*WIDTH] = pix_hyst;
+                dst[xb + yi*LINE_BEATS] = pix_out;
             }
         }
+
+        // rest of the bins when the frame is shorter than NUM_BINS beats
+        for(; bin < NUM_BINS; bin++) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=0 max=0
+            HystHistogramBin(hist, prev, bin, target, hist_ratio, cum, found);
+        }
+
+        // flush the last bins and swap the banks
+        for(int p = 0; p < PPC; p++) {
+            hist.bins[bank][p][last_bin[p]] = last_acc[p];
+        }
+        hist.count[bank] = count;
+        hist.count[prev] = 0;
+        hist.bank = prev;
     }
 
-    template<uint32_t WIDTH, uint32_t HEIGHT>
-    inline void HlsImProc::ZeroPadding(uint8_t* src, uint8_t* dst, uint32_t padding_size) {
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_T, typename DST_T>
+    inline void HlsImProc::HystThresholdComp(SRC_T src, DST_T dst, uint32_t width, uint32_t height) {
+        const int WINDOW_SIZE = 3;
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        LineBuffer<uint8_t, WINDOW_SIZE, WIDTH, PPC> line_buf;
+        SlidingWindow<uint8_t, WINDOW_SIZE, PPC> window_buf;
+
         // image proc loop
-        for(int yi = 0; yi < HEIGHT; yi++) {
-            for(int xi = 0; xi < WIDTH; xi++) {
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
                 #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
                 #pragma HLS LOOP_FLATTEN off
 
+                //--- comparison operation
+                const PixBeat<uint8_t, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                PixBeat<uint8_t, PPC> pix_out;
+
+                //-- line buffer (rows above the frame are cleared at the first line) and
+                //   window buffer (columns left of the frame are cleared at the first pixel)
+                if(xb == 0) {
+                    line_buf.NextLine(yi == 0);
+                }
+                window_buf.Shift(xb == 0 && yi == 0);
+                for(int p = 0; p < PPC; p++) {
+                    uint8_t column[WINDOW_SIZE];
+                    line_buf.Insert(xb*PPC + p, pix_in.pix[p], column);
+                    window_buf.Insert(p, column);
+                }
+
                 // output
-                uint8_t pix = src[xi + yi*WIDTH];
-                if((padding_size < xi && xi < WIDTH - padding_size) &&
-                   (padding_size < yi && yi < HEIGHT - padding_size)) {
-                    dst[xi + yi*WIDTH] = pix;
+                for(int p = 0; p < PPC; p++) {
+                    uint8_t pix_window[WINDOW_SIZE][WINDOW_SIZE];
+                    window_buf.Get(p, pix_window);
+                    pix_out.pix[p] = HystThresholdCompPix(pix_window);
+                }
+                dst[xb + yi*LINE_BEATS] = pix_out;
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_T, typename DST_T>
+    inline void HlsImProc::ZeroPadding(SRC_T src, DST_T dst, uint32_t padding_size,
+                                       uint32_t width, uint32_t height) {
+        #pragma HLS INLINE
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        // the window is the whole frame
+        ZeroPaddingRoi<WIDTH, HEIGHT, PPC>(src, dst, padding_size, 0, 0, im_width, im_height, im_width, im_height);
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_T, typename DST_T>
+    inline void HlsImProc::ZeroPaddingRoi(SRC_T src, DST_T dst, uint32_t padding_size,
+                                          int32_t win_x, int32_t win_y, uint32_t width, uint32_t height,
+                                          uint32_t frame_width, uint32_t frame_height) {
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // window size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
+                #pragma HLS LOOP_FLATTEN off
+
+                const PixBeat<uint8_t, PPC> pix_in = src[xb + yi*LINE_BEATS];
+                PixBeat<uint8_t, PPC> pix_out;
+                for(int p = 0; p < PPC; p++) {
+                    // position in the frame
+                    const int fx = win_x + xb*PPC + p;
+                    const int fy = win_y + yi;
+                    if((int(padding_size) < fx && fx < int(frame_width - padding_size)) &&
+                       (int(padding_size) < fy && fy < int(frame_height - padding_size))) {
+                        pix_out.pix[p] = pix_in.pix[p];
+                    }
+                    else {
+                        pix_out.pix[p] = 0;
+                    }
+                }
+
+                // output
+                dst[xb + yi*LINE_BEATS] = pix_out;
+            }
+        }
+    }
+
+    inline uint32_t HlsImProc::Crc32Byte(uint32_t crc, uint8_t data) {
+        #pragma HLS INLINE
+        // one bit per step (unrolled to an XOR network of the 32 + 8 input bits)
+        crc ^= data;
+        for(int bit = 0; bit < 8; bit++) {
+            #pragma HLS UNROLL
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : (crc >> 1);
+        }
+        return crc;
+    }
+
+    inline uint8_t HlsImProc::GrayPix(const ap_uint<24>& pix_data) {
+        #pragma HLS INLINE
+        int pix_gray;
+
+        // Y = B*0.144 + G*0.587 + R*0.299
+        pix_gray = 9437*(pix_data & 0x0000ff)
+            + 38469*((pix_data & 0x00ff00) >> 8 )
+            + 19595*((pix_data & 0xff0000) >> 16);
+
+        pix_gray >>= 16;
+
+        // to consider saturation
+        if(pix_gray < 0) {
+            pix_gray = 0;
+        }
+        else if(pix_gray > 255) {
+            pix_gray = 255;
+        }
+
+        return pix_gray;
+    }
+
+    template<PixFormat FMT>
+    inline uint8_t HlsImProc::BayerLumaPix(uint8_t pix_ul, uint8_t pix_u, uint8_t pix_l, uint8_t pix, int xi, int yi) {
+        #pragma HLS INLINE
+        // the first line/column have no complete window (the raw value is passed)
+        if(xi == 0 || yi == 0) {
+            return pix;
+        }
+
+        // every 2x2 window of RGGB has one R at (even, even), two G and one B at (odd, odd)
+        const bool odd_x = xi & 1;
+        const bool odd_y = yi & 1;
+        const bool pix_is_g = (odd_x != odd_y);
+        int r, g0, g1, b;
+        if(pix_is_g) {
+            g0 = pix_ul;
+            g1 = pix;
+            r  = (odd_x) ? pix_l : pix_u;
+            b  = (odd_x) ? pix_u : pix_l;
+        }
+        else {
+            g0 = pix_u;
+            g1 = pix_l;
+            r  = (odd_x) ? pix_ul : pix;
+            b  = (odd_x) ? pix : pix_ul;
+        }
+
+        if(FMT == PIX_BAYER_G) {
+            // green of G sites, mean of the two greens at R/B sites
+            return pix_is_g ? uint8_t(pix) : uint8_t((g0 + g1) >> 1);
+        }
+        else {
+            // Y = R*0.299 + G*0.587 + B*0.114 (8bit left shift, 77 + 2*75 + 29 = 256)
+            return (77*r + 75*(g0 + g1) + 29*b + 128) >> 8;
+        }
+    }
+
+    template<int KSIZE, int SIGMA_X100>
+    inline ap_uint<16> HlsImProc::GaussColumn(const uint8_t column[KSIZE]) {
+        #pragma HLS INLINE
+        typedef GaussKernel<KSIZE, SIGMA_X100> Kernel;
+
+        // 255 << SHIFT at most
+        ap_uint<16> vsum = 0;
+        for(int yw = 0; yw < KSIZE; yw++) {
+            vsum += column[yw] * Kernel::COEF[yw];
+        }
+        return vsum;
+    }
+
+    template<int KSIZE, int SIGMA_X100>
+    inline uint8_t HlsImProc::GaussRow(const ap_uint<16> vsum[KSIZE]) {
+        #pragma HLS INLINE
+        typedef GaussKernel<KSIZE, SIGMA_X100> Kernel;
+
+        // 255 << (2 * SHIFT) at most, the same sum as the 2D kernel
+        ap_uint<24> pix_gauss = 0;
+        for(int xw = 0; xw < KSIZE; xw++) {
+            pix_gauss += vsum[xw] * Kernel::COEF[xw];
+        }
+        return pix_gauss >> (2 * Kernel::SHIFT);
+    }
+
+    inline void HlsImProc::SobelConv(const uint8_t window_buf[3][3], ap_int<11>& pix_h_sobel, ap_int<11>& pix_v_sobel) {
+        #pragma HLS INLINE
+        const int KERNEL_SIZE = 3;
+
+        //-- 3x3 Horizontal Sobel kernel
+        const int H_SOBEL_KERNEL[KERNEL_SIZE][KERNEL_SIZE] = {  { 1,  0, -1},
+                                                                { 2,  0, -2},
+                                                                { 1,  0, -1}   };
+        //-- 3x3 vertical Sobel kernel
+        const int V_SOBEL_KERNEL[KERNEL_SIZE][KERNEL_SIZE] = {  { 1,  2,  1},
+                                                                { 0,  0,  0},
+                                                                {-1, -2, -1}   };
+
+        #pragma HLS ARRAY_PARTITION variable=H_SOBEL_KERNEL complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=V_SOBEL_KERNEL complete dim=0
+
+        //-- convolution
+        pix_h_sobel = 0; // -1020 ~ 1020
+        pix_v_sobel = 0;
+
+        // convolution using by holizonal kernel
+        for(int yw = 0; yw < KERNEL_SIZE; yw++) {
+            for(int xw = 0; xw < KERNEL_SIZE; xw++) {
+                pix_h_sobel += window_buf[yw][xw] * H_SOBEL_KERNEL[yw][xw];
+            }
+        }
+
+        // convolution using by vertical kernel
+        for(int yw = 0; yw < KERNEL_SIZE; yw++) {
+            for(int xw = 0; xw < KERNEL_SIZE; xw++) {
+                pix_v_sobel += window_buf[yw][xw] * V_SOBEL_KERNEL[yw][xw];
+            }
+        }
+    }
+
+    template<MagMode MAG>
+    inline GradPix HlsImProc::SobelPix(const uint8_t window_buf[3][3]) {
+        #pragma HLS INLINE
+        //-- convolution
+        ap_int<11> pix_h_sobel; // -1020 ~ 1020
+        ap_int<11> pix_v_sobel;
+        SobelConv(window_buf, pix_h_sobel, pix_v_sobel);
+
+        //-- gradient magnitude
+        const ap_uint<10> abs_h = (pix_h_sobel < 0) ? ap_int<11>(-pix_h_sobel) : pix_h_sobel;
+        const ap_uint<10> abs_v = (pix_v_sobel < 0) ? ap_int<11>(-pix_v_sobel) : pix_v_sobel;
+        ap_uint<11> pix_sobel;
+
+        if(MAG == MAG_EXACT) {
+            const ap_uint<21> pix_sq = abs_h * abs_h + abs_v * abs_v;
+            pix_sobel = hls::sqrt(float(pix_sq));
+        }
+        else if(MAG == MAG_ISQRT) {
+            // restoring square root of 8 bits (anything from 256 on is saturated below)
+            const ap_uint<21> pix_sq = abs_h * abs_h + abs_v * abs_v;
+            if(pix_sq >= 256 * 256) {
+                pix_sobel = 256;
+            }
+            else {
+                ap_uint<17> rem = pix_sq;
+                ap_uint<9> root = 0;
+                for(int b = 7; b >= 0; b--) {
+                    #pragma HLS UNROLL
+                    const ap_uint<17> trial = ((ap_uint<17>(root) << 2) | 1) << (2 * b);
+                    root <<= 1;
+                    if(rem >= trial) {
+                        rem -= trial;
+                        root |= 1;
+                    }
+                }
+                pix_sobel = root;
+            }
+        }
+        else if(MAG == MAG_L1) {
+            pix_sobel = abs_h + abs_v;
+        }
+        else {
+            const ap_uint<10> abs_max = (abs_h < abs_v) ? abs_v : abs_h;
+            const ap_uint<10> abs_min = (abs_h < abs_v) ? abs_h : abs_v;
+            pix_sobel = (ap_uint<16>(abs_max * 30 + abs_min * 15)) >> 5;
+        }
+
+        // to consider saturation
+        if(255 < pix_sobel) {
+            pix_sobel = 255;
+        }
+
+        //-- gradient direction
+        // t = gy * 256 / gx truncated toward zero is classified by cross multiplication
+        // (n = t * d with d = |gx| > 0, t <= 106 is n < 107 * d, 106 < t is 107 * d <= n),
+        // gx = 0 (tan = inf) falls through every range below
+        const ap_int<19> n = (pix_h_sobel < 0) ? ap_int<19>(-pix_v_sobel * 256) : ap_int<19>(pix_v_sobel * 256);
+        const ap_uint<10> d = abs_h;
+        const ap_int<21> d_106 = d * 106;
+        const ap_int<21> d_107 = d * 107;
+        const ap_int<21> d_618 = d * 618;
+
+        GradDir grad_sobel;
+
+        // 112.5° ~ 157.5° (tan 112.5° ~= -2.4142, tan 157.5° ~= -0.4142)
+        if(-d_618 < n && n <= -d_106) {
+            grad_sobel = DIR_135;
+        }
+        // -22.5° ~ 22.5° (tan -22.5° ~= -0.4142, tan 22.5° = 0.4142)
+        else if(-d_106 < n && n < d_107) {
+            grad_sobel = DIR_0;
+        }
+        // 22.5° ~ 67.5° (tan 22.5° ~= 0.4142, tan 67.5° = 2.4142)
+        else if(d_107 <= n && n < d_618) {
+            grad_sobel = DIR_45;
+        }
+        // 67.5° ~ 112.5° (to inf)
+        else {
+            grad_sobel = DIR_90;
+        }
+
+        return MakeGradPix(pix_sobel, grad_sobel);
+    }
+
+    inline uint8_t HlsImProc::NonMaxSuppressionPix(const GradPix window_buf[3][3]) {
+        #pragma HLS INLINE
+        const int WINDOW_SIZE = 3;
+
+        uint8_t value_nms = GradValue(window_buf[WINDOW_SIZE / 2][WINDOW_SIZE / 2]);
+        GradDir grad_nms = GradDirection(window_buf[WINDOW_SIZE / 2][WINDOW_SIZE / 2]);
+        // grad 0° -> left, right
+        if(grad_nms == DIR_0) {
+            if(value_nms < GradValue(window_buf[WINDOW_SIZE / 2][0]) ||
+               value_nms < GradValue(window_buf[WINDOW_SIZE / 2][WINDOW_SIZE - 1])) {
+                value_nms = 0;
+            }
+        }
+        // grad 45° -> upper left, bottom right
+        else if(grad_nms == DIR_45) {
+            if(value_nms < GradValue(window_buf[0][0]) ||
+               value_nms < GradValue(window_buf[WINDOW_SIZE - 1][WINDOW_SIZE - 1])) {
+                value_nms = 0;
+            }
+        }
+        // grad 90° -> upper, bottom
+        else if(grad_nms == DIR_90) {
+            if(value_nms < GradValue(window_buf[0][WINDOW_SIZE - 1]) ||
+               value_nms < GradValue(window_buf[WINDOW_SIZE - 1][WINDOW_SIZE / 2])) {
+                value_nms = 0;
+            }
+        }
+        // grad 135° -> bottom left, upper right
+        else if(grad_nms == DIR_135) {
+            if(value_nms < GradValue(window_buf[WINDOW_SIZE - 1][0]) ||
+               value_nms < GradValue(window_buf[0][WINDOW_SIZE - 1])) {
+                value_nms = 0;
+            }
+        }
+
+        return value_nms;
+    }
+
+    inline uint8_t HlsImProc::HystThresholdPix(uint8_t pix, uint8_t hthr, uint8_t lthr) {
+        #pragma HLS INLINE
+        if(pix < lthr) {
+            return 0;
+        }
+        else if(pix > hthr) {
+            return 255;
+        }
+        else {
+            return 1;
+        }
+    }
+
+    template<int PPC>
+    inline void HlsImProc::HystHistogramBin(HystHistogram<PPC>& hist, int prev, int bin, uint32_t target,
+                                            uint8_t hist_ratio, uint32_t& cum, bool& found) {
+        #pragma HLS INLINE
+        for(int p = 0; p < PPC; p++) {
+            cum += hist.bins[prev][p][bin];
+            hist.bins[prev][p][bin] = 0;
+        }
+        if(!found && target <= cum) {
+            found = true;
+            hist.hthr = bin;
+            hist.lthr = (bin * hist_ratio) >> 8;
+            hist.valid = true;
+        }
+    }
+
+    inline uint8_t HlsImProc::HystThresholdCompPix(const uint8_t window_buf[3][3]) {
+        #pragma HLS INLINE
+        const int WINDOW_SIZE = 3;
+
+        uint8_t pix_hyst = 0;
+        for(int yw = 0; yw < WINDOW_SIZE; yw++) {
+            for(int xw = 0; xw < WINDOW_SIZE; xw++) {
+                if(window_buf[WINDOW_SIZE / 2][WINDOW_SIZE / 2] != 0) {
+                    if(window_buf[yw][xw] == 0xFF) {
+                        pix_hyst = 0xFF;
+                    }
+                }
+            }
+        }
+        return pix_hyst;
+    }
+
+    template<int SIZE, int COLS, typename T>
+    inline void HlsImProc::PixWindow(const T window_buf[SIZE][COLS], int p, T pix_window[SIZE][SIZE]) {
+        #pragma HLS INLINE
+        for(int yw = 0; yw < SIZE; yw++) {
+            for(int xw = 0; xw < SIZE; xw++) {
+                pix_window[yw][xw] = window_buf[yw][p + xw];
+            }
+        }
+    }
+
+    template<int SIZE, typename T>
+    inline void HlsImProc::CopyWindow(const T src[SIZE][SIZE], T dst[SIZE][SIZE]) {
+        #pragma HLS INLINE
+        for(int yw = 0; yw < SIZE; yw++) {
+            for(int xw = 0; xw < SIZE; xw++) {
+                dst[yw][xw] = src[yw][xw];
+            }
+        }
+    }
+
+    template<int PPC, MagMode MAG>
+    inline PixBeat<uint8_t, PPC> HlsImProc::CannyFusedBeat(const PixBeat<uint8_t, PPC>& pix_in, FusedLineWord col[PPC],
+                                                           ap_uint<16> gauss_win[5 + PPC - 1],
+                                                           uint8_t sobel_win[3][3 + PPC - 1],
+                                                           GradPix nms_win[3][3 + PPC - 1],
+                                                           uint8_t hyst_win[3][3 + PPC - 1],
+                                                           bool clear_win, int xb, int yi,
+                                                           uint8_t hthr, uint8_t lthr, uint32_t padding_size,
+                                                           uint32_t im_width, uint32_t im_height) {
+        #pragma HLS INLINE
+        const int GAUSS_SIZE = 5;
+        const int WINDOW_SIZE = 3;
+        const GradPix zero_pix = MakeGradPix(0, DIR_0);
+
+        PixBeat<uint8_t, PPC> pix_out;
+
+        //-- line buffer (rows above the frame are cleared at the first line)
+        if(yi == 0) {
+            for(int p = 0; p < PPC; p++) {
+                for(int yl = 0; yl < GAUSS_SIZE - 1; yl++) {
+                    col[p].gray[yl] = 0;
+                }
+                for(int yl = 0; yl < WINDOW_SIZE - 1; yl++) {
+                    col[p].gauss[yl] = 0;
+                    col[p].grad[yl]  = zero_pix;
+                    col[p].hyst[yl]  = 0;
+                }
+            }
+        }
+
+        //-- window buffers (columns left of the frame are cleared at the first pixel)
+        for(int xw = 0; xw < GAUSS_SIZE - 1; xw++) {
+            gauss_win[xw] = clear_win ? ap_uint<16>(0) : gauss_win[xw + PPC];
+        }
+        for(int yw = 0; yw < WINDOW_SIZE; yw++) {
+            for(int xw = 0; xw < WINDOW_SIZE - 1; xw++) {
+                sobel_win[yw][xw] = clear_win ? 0 : sobel_win[yw][xw + PPC];
+                nms_win[yw][xw]   = clear_win ? zero_pix : nms_win[yw][xw + PPC];
+                hyst_win[yw][xw]  = clear_win ? 0 : hyst_win[yw][xw + PPC];
+            }
+        }
+
+        //--- gaussian bler
+        uint8_t pix_gauss[PPC];
+        for(int p = 0; p < PPC; p++) {
+            uint8_t column[GAUSS_SIZE];
+            for(int yw = 0; yw < GAUSS_SIZE - 1; yw++) {
+                column[yw] = col[p].gray[yw];
+            }
+            column[GAUSS_SIZE - 1] = pix_in.pix[p];
+            gauss_win[GAUSS_SIZE - 1 + p] = GaussColumn<GAUSS_SIZE, 0>(column);
+        }
+        for(int p = 0; p < PPC; p++) {
+            ap_uint<16> vsum[GAUSS_SIZE];
+            for(int xw = 0; xw < GAUSS_SIZE; xw++) {
+                vsum[xw] = gauss_win[p + xw];
+            }
+            pix_gauss[p] = GaussRow<GAUSS_SIZE, 0>(vsum);
+        }
+
+        //--- sobel
+        GradPix pix_grad[PPC];
+        for(int p = 0; p < PPC; p++) {
+            for(int yw = 0; yw < WINDOW_SIZE - 1; yw++) {
+                sobel_win[yw][WINDOW_SIZE - 1 + p] = col[p].gauss[yw];
+            }
+            sobel_win[WINDOW_SIZE - 1][WINDOW_SIZE - 1 + p] = pix_gauss[p];
+        }
+        for(int p = 0; p < PPC; p++) {
+            const int xi = xb*PPC + p;
+            uint8_t pix_window[WINDOW_SIZE][WINDOW_SIZE];
+            PixWindow<WINDOW_SIZE>(sobel_win, p, pix_window);
+            pix_grad[p] = SobelPix<MAG>(pix_window);
+            if(!((WINDOW_SIZE < xi && xi < im_width - WINDOW_SIZE) &&
+                 (WINDOW_SIZE < yi && yi < im_height - WINDOW_SIZE))) {
+                pix_grad[p].range(7, 0) = 0;
+            }
+        }
+
+        //--- non-maximum suppression, zero padding and hysteresis threshold
+        uint8_t pix_hyst[PPC];
+        for(int p = 0; p < PPC; p++) {
+            for(int yw = 0; yw < WINDOW_SIZE - 1; yw++) {
+                nms_win[yw][WINDOW_SIZE - 1 + p] = col[p].grad[yw];
+            }
+            nms_win[WINDOW_SIZE - 1][WINDOW_SIZE - 1 + p] = pix_grad[p];
+        }
+        for(int p = 0; p < PPC; p++) {
+            const int xi = xb*PPC + p;
+            GradPix pix_window[WINDOW_SIZE][WINDOW_SIZE];
+            PixWindow<WINDOW_SIZE>(nms_win, p, pix_window);
+            uint8_t pix_nms = NonMaxSuppressionPix(pix_window);
+
+            // zero padding (covers the boundary mask of non-maximum suppression)
+            if(!((padding_size < xi && xi < im_width - padding_size) &&
+                 (padding_size < yi && yi < im_height - padding_size) &&
+                 (WINDOW_SIZE < xi && xi < im_width - WINDOW_SIZE) &&
+                 (WINDOW_SIZE < yi && yi < im_height - WINDOW_SIZE))) {
+                pix_nms = 0;
+            }
+
+            pix_hyst[p] = HystThresholdPix(pix_nms, hthr, lthr);
+        }
+
+        //--- comparison operation
+        for(int p = 0; p < PPC; p++) {
+            for(int yw = 0; yw < WINDOW_SIZE - 1; yw++) {
+                hyst_win[yw][WINDOW_SIZE - 1 + p] = col[p].hyst[yw];
+            }
+            hyst_win[WINDOW_SIZE - 1][WINDOW_SIZE - 1 + p] = pix_hyst[p];
+        }
+        for(int p = 0; p < PPC; p++) {
+            uint8_t pix_window[WINDOW_SIZE][WINDOW_SIZE];
+            PixWindow<WINDOW_SIZE>(hyst_win, p, pix_window);
+            pix_out.pix[p] = HystThresholdCompPix(pix_window);
+        }
+
+        //-- shift the columns
+        for(int p = 0; p < PPC; p++) {
+            for(int yl = 0; yl < GAUSS_SIZE - 2; yl++) {
+                col[p].gray[yl] = col[p].gray[yl + 1];
+            }
+            col[p].gray[GAUSS_SIZE - 2] = pix_in.pix[p];
+            for(int yl = 0; yl < WINDOW_SIZE - 2; yl++) {
+                col[p].gauss[yl] = col[p].gauss[yl + 1];
+                col[p].grad[yl]  = col[p].grad[yl + 1];
+                col[p].hyst[yl]  = col[p].hyst[yl + 1];
+            }
+            col[p].gauss[WINDOW_SIZE - 2] = pix_gauss[p];
+            col[p].grad[WINDOW_SIZE - 2]  = pix_grad[p];
+            col[p].hyst[WINDOW_SIZE - 2]  = pix_hyst[p];
+        }
+
+        return pix_out;
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, MagMode MAG, typename SRC_T, typename DST_T>
+    inline void HlsImProc::CannyFused(SRC_T src, DST_T dst, uint8_t hthr, uint8_t lthr, uint32_t padding_size,
+                                      uint32_t width, uint32_t height) {
+        const int GAUSS_SIZE = 5;
+        const int WINDOW_SIZE = 3;
+        const int LINE_BEATS = WIDTH / PPC;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+        const int line_beats = im_width / PPC;
+
+        FusedLineWord line_buf[WIDTH];
+        ap_uint<16> gauss_win[GAUSS_SIZE + PPC - 1];
+        uint8_t sobel_win[WINDOW_SIZE][WINDOW_SIZE + PPC - 1];
+        GradPix nms_win[WINDOW_SIZE][WINDOW_SIZE + PPC - 1];
+        uint8_t hyst_win[WINDOW_SIZE][WINDOW_SIZE + PPC - 1];
+
+        #pragma HLS DATA_PACK variable=line_buf
+        #pragma HLS ARRAY_PARTITION variable=line_buf cyclic factor=PPC dim=1
+        #pragma HLS ARRAY_PARTITION variable=gauss_win complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=sobel_win complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=nms_win complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=hyst_win complete dim=0
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xb = 0; xb < line_beats; xb++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=LINE_BEATS
+                #pragma HLS LOOP_FLATTEN off
+                #pragma HLS DEPENDENCE variable=line_buf inter false
+
+                FusedLineWord col[PPC];
+                for(int p = 0; p < PPC; p++) {
+                    col[p] = line_buf[xb*PPC + p];
+                }
+
+                dst[xb + yi*LINE_BEATS] = CannyFusedBeat<PPC, MAG>(src[xb + yi*LINE_BEATS], col,
+                                                                   gauss_win, sobel_win, nms_win, hyst_win,
+                                                                   (xb == 0 && yi == 0), xb, yi,
+                                                                   hthr, lthr, padding_size, im_width, im_height);
+
+                // write the shifted columns back
+                for(int p = 0; p < PPC; p++) {
+                    line_buf[xb*PPC + p] = col[p];
+                }
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename DST_T>
+    inline void HlsImProc::AXIS2GrayArrayRoi(hls::stream<ImAxis<24> >& axis_src, DST_T dst,
+                                             int32_t win_x, uint32_t win_y, uint32_t width, uint32_t height,
+                                             uint32_t frame_width, uint32_t frame_height) {
+        // frame and window size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width   = (frame_width < WIDTH) ? frame_width : WIDTH;
+        const uint32_t im_height  = (frame_height < HEIGHT) ? frame_height : HEIGHT;
+        const uint32_t win_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t win_height = (height < HEIGHT) ? height : HEIGHT;
+
+        ImAxis<24> axis_reader; // for read AXI4-Stream
+
+        bool sof = false;        // Start of Frame
+        bool eol = false;        // End of Line
+
+        // wait for the user signal to be asserted
+        while (!sof) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT avg=0 max=0
+
+            axis_src >> axis_reader;
+            sof = axis_reader.user.to_int();
+        }
+
+        // the first window line left of the frame starts above the frame
+        if(win_y == 0) {
+            for(int wx = 0; wx < -win_x; wx++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                dst[wx] = PixBeat<uint8_t, 1>(0);
+            }
+        }
+
+        // image proc loop (every pixel of the frame is read, the window pixels are written)
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            eol = false;
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+
+                // get pix until the last signal to be asserted
+                if(sof || eol) {
+                    sof = false;
+                    eol = axis_reader.last.to_int();
                 }
                 else {
-                    dst[xi + yi*WIDTH] = 0;
+                    axis_src >> axis_reader;
+                    eol = axis_reader.last.to_int();
+                }
+
+                // output (position in the window, wrapped around when left/above of it; the last -win_x
+                // pixels of the line are the first ones of the window line below)
+                const bool wrap = (xi >= int(im_width) + win_x);
+                const uint32_t wx = wrap ? xi - win_x - im_width : xi - win_x;
+                const uint32_t wy = wrap ? yi + 1 - win_y : yi - win_y;
+                if(wx < win_width && wy < win_height) {
+                    dst[wx + wy*WIDTH] = PixBeat<uint8_t, 1>(GrayPix(axis_reader.data));
+                }
+            }
+
+            // when width param set less than actual frame size
+            // wait for the last signal to be asserted
+            while (!eol) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT avg=0 max=0
+                axis_src >> axis_reader;
+                eol = axis_reader.last.to_int();
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, typename SRC_T>
+    inline void HlsImProc::GrayArray2AXISRoi(SRC_T src, hls::stream<ImAxis<24> >& axis_dst,
+                                             uint32_t roi_x, uint32_t roi_y, uint32_t roi_width, uint32_t roi_height,
+                                             uint32_t width, uint32_t height) {
+        // window size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        ImAxis<24> axis_writer; // for write AXI4-Stream
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            const uint32_t ry = yi - roi_y;
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+
+                const PixBeat<uint8_t, 1> pix_in = src[xi + yi*WIDTH];
+                const unsigned int pix_out = pix_in.pix[0];
+
+                // the pixels around the ROI are dropped (position in the ROI, wrapped around when left/above of it)
+                const uint32_t rx = xi - roi_x;
+                if(rx < roi_width && ry < roi_height) {
+                    axis_writer.data = pix_out << 16 | pix_out << 8 | pix_out;
+                    // assert user signal at start of frame
+                    axis_writer.user = (rx == 0 && ry == 0);
+                    // assert last signal at end of line
+                    axis_writer.last = (rx == roi_width - 1);
+
+                    // output
+                    axis_dst << axis_writer;
+                }
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int STREAMS, int DEST_W, typename DST_T>
+    inline void HlsImProc::AXIS2GrayArrayMulti(hls::stream<ImAxis<24, 1, DEST_W> >& axis_src, DST_T dst,
+                                               uint32_t width, uint32_t height) {
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        ImAxis<24, 1, DEST_W> axis_reader; // for read AXI4-Stream
+        bool sof = false;        // Start of Frame (of any stream)
+        bool eol = false;        // End of Line
+
+        // wait for the user signal to be asserted
+        while (!sof) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT avg=0 max=0
+
+            axis_src >> axis_reader;
+            sof = axis_reader.user.to_int();
+        }
+
+        // image proc loop (the stream ID and SOF of each line are taken from its first pixel)
+        for(int yi = 0; yi < STREAMS * im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=STREAMS*HEIGHT
+            eol = false;
+            ap_uint<1> line_user = 0;
+            ap_uint<DEST_W> line_dest = 0;
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+
+                // get pix until the last signal to be asserted
+                if(sof || eol) {
+                    // when frame is started (first pix have already latched)
+                    // or
+                    // when width param set more than actual frame size
+                    sof = false;
+                    eol = axis_reader.last.to_int();
+                }
+                else {
+                    axis_src >> axis_reader;
+                    eol = axis_reader.last.to_int();
+                }
+                if(xi == 0) {
+                    line_user = axis_reader.user;
+                    line_dest = axis_reader.dest;
+                }
+
+                // output
+                StreamPix<uint8_t, DEST_W> pix_out;
+                pix_out.pix  = GrayPix(axis_reader.data);
+                pix_out.user = (xi == 0) ? line_user : ap_uint<1>(0);
+                pix_out.dest = line_dest;
+                dst[xi + yi*WIDTH] = pix_out;
+            }
+
+            // when width param set less than actual frame size
+            // wait for the last signal to be asserted
+            while (!eol) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT avg=0 max=0
+                axis_src >> axis_reader;
+                eol = axis_reader.last.to_int();
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int STREAMS, int DEST_W, typename SRC_T>
+    inline void HlsImProc::GrayArray2AXISMulti(SRC_T src, hls::stream<ImAxis<24, 1, DEST_W> >& axis_dst,
+                                               uint32_t width, uint32_t height) {
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        ImAxis<24, 1, DEST_W> axis_writer; // for write AXI4-Stream
+
+        // image proc loop
+        for(int yi = 0; yi < STREAMS * im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=STREAMS*HEIGHT
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+
+                const StreamPix<uint8_t, DEST_W> pix_in = src[xi + yi*WIDTH];
+                unsigned int pix_out = pix_in.pix;
+                axis_writer.data = pix_out << 16 | pix_out << 8 | pix_out;
+
+                // user/dest of the source line, last signal at end of line
+                axis_writer.user = pix_in.user;
+                axis_writer.dest = pix_in.dest;
+                axis_writer.last = (xi == im_width - 1);
+
+                // output
+                axis_dst << axis_writer;
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int STREAMS, int DEST_W, MagMode MAG, typename SRC_T, typename DST_T>
+    inline void HlsImProc::CannyFusedMulti(SRC_T src, DST_T dst, const uint8_t hthr[STREAMS], const uint8_t lthr[STREAMS],
+                                           uint32_t padding_size, uint32_t width, uint32_t height) {
+        const int GAUSS_SIZE = 5;
+        const int WINDOW_SIZE = 3;
+
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        // one bank of the line buffer, the window buffers and the line counter for each stream
+        FusedLineWord line_buf[STREAMS][WIDTH];
+        ap_uint<16> gauss_bank[STREAMS][GAUSS_SIZE];
+        uint8_t sobel_bank[STREAMS][WINDOW_SIZE][WINDOW_SIZE];
+        GradPix nms_bank[STREAMS][WINDOW_SIZE][WINDOW_SIZE];
+        uint8_t hyst_bank[STREAMS][WINDOW_SIZE][WINDOW_SIZE];
+        uint32_t line_bank[STREAMS];
+
+        // window buffers of the current line
+        ap_uint<16> gauss_win[GAUSS_SIZE];
+        uint8_t sobel_win[WINDOW_SIZE][WINDOW_SIZE];
+        GradPix nms_win[WINDOW_SIZE][WINDOW_SIZE];
+        uint8_t hyst_win[WINDOW_SIZE][WINDOW_SIZE];
+
+        #pragma HLS DATA_PACK variable=line_buf
+        #pragma HLS ARRAY_PARTITION variable=line_buf complete dim=1
+        #pragma HLS ARRAY_PARTITION variable=gauss_bank complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=sobel_bank complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=nms_bank complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=hyst_bank complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=line_bank complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=gauss_win complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=sobel_win complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=nms_win complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=hyst_win complete dim=0
+
+        // registers of each stream
+        uint8_t hthr_reg[STREAMS];
+        uint8_t lthr_reg[STREAMS];
+        #pragma HLS ARRAY_PARTITION variable=hthr_reg complete dim=0
+        #pragma HLS ARRAY_PARTITION variable=lthr_reg complete dim=0
+        for(int si = 0; si < STREAMS; si++) {
+            #pragma HLS UNROLL
+            hthr_reg[si]  = hthr[si];
+            lthr_reg[si]  = lthr[si];
+            line_bank[si] = 0;
+        }
+
+        // image proc loop (yi counts the lines of all streams)
+        for(int yi = 0; yi < STREAMS * im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=STREAMS*HEIGHT
+            int s = 0;  // stream of the line
+            int ys = 0; // line of the frame of stream s
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+                #pragma HLS DEPENDENCE variable=line_buf inter false
+
+                const StreamPix<uint8_t, DEST_W> pix_in = src[xi + yi*WIDTH];
+
+                //-- switch the banks to the stream of the line (a new frame of it starts at SOF)
+                if(xi == 0) {
+                    s  = pix_in.dest.to_uint() % STREAMS;
+                    ys = pix_in.user ? 0 : line_bank[s];
+                    for(int xw = 0; xw < GAUSS_SIZE; xw++) {
+                        gauss_win[xw] = gauss_bank[s][xw];
+                    }
+                    CopyWindow<WINDOW_SIZE>(sobel_bank[s], sobel_win);
+                    CopyWindow<WINDOW_SIZE>(nms_bank[s], nms_win);
+                    CopyWindow<WINDOW_SIZE>(hyst_bank[s], hyst_win);
+                }
+
+                FusedLineWord col[1];
+                col[0] = line_buf[s][xi];
+
+                const PixBeat<uint8_t, 1> pix_beat(pix_in.pix);
+                StreamPix<uint8_t, DEST_W> pix_out;
+                pix_out.pix  = CannyFusedBeat<1, MAG>(pix_beat, col, gauss_win, sobel_win, nms_win, hyst_win,
+                                                      (xi == 0 && ys == 0), xi, ys,
+                                                      hthr_reg[s], lthr_reg[s], padding_size, im_width, im_height);
+                pix_out.user = pix_in.user;
+                pix_out.dest = pix_in.dest;
+                dst[xi + yi*WIDTH] = pix_out;
+
+                // write the shifted column back
+                line_buf[s][xi] = col[0];
+
+                //-- save the windows (the left columns of the next line of the stream) at end of line
+                if(xi == im_width - 1) {
+                    for(int xw = 0; xw < GAUSS_SIZE; xw++) {
+                        gauss_bank[s][xw] = gauss_win[xw];
+                    }
+                    CopyWindow<WINDOW_SIZE>(sobel_win, sobel_bank[s]);
+                    CopyWindow<WINDOW_SIZE>(nms_win, nms_bank[s]);
+                    CopyWindow<WINDOW_SIZE>(hyst_win, hyst_bank[s]);
+                    line_bank[s] = ys + 1;
+                }
+            }
+        }
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, uint32_t MAX_LABELS, typename SRC_T>
+    inline void HlsImProc::HystLabel(SRC_T src, CompLabel label_buf[WIDTH * HEIGHT],
+                                     CompLabel label_root[MAX_LABELS], bool label_strong[MAX_LABELS], bool& overflow,
+                                     uint32_t width, uint32_t height) {
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        // labels of the previous line
+        CompLabel line_buf[WIDTH];
+
+        // copy of label_root for the first of the two lookups of a label of the previous line
+        // (one read and one write of each table per pixel)
+        CompLabel label_copy[MAX_LABELS];
+
+        // merges of the frame in order (label retired, label it was merged into);
+        // a label is retired once at most, when it is merged into a smaller one
+        CompLabel merge_from[MAX_LABELS];
+        CompLabel merge_to[MAX_LABELS];
+        uint32_t num_merges = 0;
+
+        // label 0 is the background and label 1 is given to the strong pixels
+        // that start a new component after the table is full
+        // (weak pixels that start a new component after that are dropped)
+        label_root[0]   = 0;
+        label_copy[0]   = 0;
+        label_strong[0] = false;
+        label_root[1]   = 1;
+        label_copy[1]   = 1;
+        label_strong[1] = true;
+        uint32_t num_labels = 2;
+        bool full = false;
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            const uint32_t line_merges = num_merges;
+
+            // a label of the previous line is one lookup from a label that was a root at the start of the line
+            // (label_copy), and that one is at most one merge from its root: the labels are given in raster order
+            // and a merge keeps the smaller label, so a component that is met again further on the previous line
+            // is the smaller one of any merge it takes part in before that
+            // (merges of the last pixels are forwarded from the registers, as the tables are written after they are read)
+            CompLabel fwd_from = 0;
+            CompLabel fwd_to   = 0;
+
+            // neighbours (upper left, upper, left) of the current pixel
+            CompLabel label_ul = 0;
+            CompLabel label_u  = (yi == 0) ? 0 : label_root[label_copy[line_buf[0]]];
+            CompLabel label_l  = 0;
+
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+                #pragma HLS DEPENDENCE variable=label_root inter false
+                #pragma HLS DEPENDENCE variable=label_copy inter false
+
+                // upper right
+                CompLabel label_ur = 0;
+                if(yi != 0 && xi != im_width - 1) {
+                    label_ur = label_root[label_copy[line_buf[xi + 1]]];
+                    if(label_ur == fwd_from) {
+                        label_ur = fwd_to;
+                    }
                 }
+
+                const uint8_t pix = src[xi + yi*WIDTH];
+                CompLabel label = 0;
+                bool merge = false;
+                if(pix != 0) {
+                    if(label_u != 0) {
+                        // upper left, upper right and left touch the upper pixel
+                        label = label_u;
+                    }
+                    else if(label_ul == 0 && label_l == 0 && label_ur == 0) {
+                        // new component
+                        if(num_labels < MAX_LABELS) {
+                            label = num_labels;
+                            label_root[label]   = label;
+                            label_copy[label]   = label;
+                            label_strong[label] = false;
+                            num_labels++;
+                        }
+                        else {
+                            label = (pix == 0xFF) ? 1 : 0;
+                            full  = true;
+                        }
+                    }
+                    else {
+                        // upper left and left touch each other, but not upper right
+                        const CompLabel label_a = (label_l != 0) ? label_l : label_ul;
+                        if(label_a != 0 && label_ur != 0 && label_a != label_ur) {
+                            // merge the components: the larger label is retired into the smaller one
+                            // (one write of each table, the line and the frame resolve the chains of merges)
+                            label = (label_a < label_ur) ? label_a : label_ur;
+                            const CompLabel retired = (label_a < label_ur) ? label_ur : label_a;
+                            label_root[retired] = label;
+                            label_copy[retired] = label;
+                            if(num_merges < MAX_LABELS) {
+                                merge_from[num_merges] = retired;
+                                merge_to[num_merges]   = label;
+                                num_merges++;
+                            }
+                            else {
+                                full = true;
+                            }
+                            fwd_from = retired;
+                            fwd_to   = label;
+                            merge = true;
+                        }
+                        else {
+                            label = (label_a != 0) ? label_a : label_ur;
+                        }
+                    }
+                    if(pix == 0xFF) {
+                        label_strong[label] = true;
+                    }
+                }
+
+                // output
+                label_buf[xi + yi*WIDTH] = label;
+                line_buf[xi] = label;
+
+                // (the upper right label may have been retired by the merge)
+                label_ul = label_u;
+                label_u  = merge ? label : label_ur;
+                label_l  = label;
+            }
+
+            // the labels retired in the line point to the label they were merged into, which may have been
+            // retired later in the line: resolved in reverse order, so that every label of the line is one
+            // lookup from its root at the start of the next line (one cycle per merge of the line)
+            CompLabel last_from = 0;
+            CompLabel last_root = 0;
+            for(uint32_t m = num_merges; m > line_merges; m--) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH/2
+                #pragma HLS DEPENDENCE variable=label_root inter false
+                const CompLabel from = merge_from[m - 1];
+                const CompLabel to   = merge_to[m - 1];
+                const CompLabel root = (to == last_from) ? last_root : label_root[to];
+                label_root[from] = root;
+                label_copy[from] = root;
+                last_from = from;
+                last_root = root;
+            }
+        }
+
+        // resolve the equivalence table at the end of frame: the merges in reverse order, so that the label
+        // a retired label pointed to at the end of its line is resolved before it, and the strong pixels of
+        // the retired labels go to their root (one cycle per merge of the frame)
+        CompLabel last_from = 0;
+        CompLabel last_root = 0;
+        for(uint32_t m = num_merges; m > 0; m--) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT max=MAX_LABELS
+            #pragma HLS DEPENDENCE variable=label_root inter false
+            #pragma HLS DEPENDENCE variable=label_strong inter false
+            const CompLabel from = merge_from[m - 1];
+            const CompLabel to   = label_copy[from];
+            const CompLabel root = (to == last_from) ? last_root : label_root[to];
+            label_root[from] = root;
+            if(label_strong[from]) {
+                label_strong[root] = true;
+            }
+            last_from = from;
+            last_root = root;
+        }
+
+        overflow = full;
+    }
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, uint32_t MAX_LABELS, typename DST_T>
+    inline void HlsImProc::HystResolve(const CompLabel label_buf[WIDTH * HEIGHT],
+                                       const CompLabel label_root[MAX_LABELS], const bool label_strong[MAX_LABELS],
+                                       DST_T dst, uint32_t width, uint32_t height) {
+        // frame size set at run time (clamped to the size of the buffers)
+        const uint32_t im_width  = (width < WIDTH) ? width : WIDTH;
+        const uint32_t im_height = (height < HEIGHT) ? height : HEIGHT;
+
+        // image proc loop
+        for(int yi = 0; yi < im_height; yi++) {
+            #pragma HLS LOOP_TRIPCOUNT max=HEIGHT
+            for(int xi = 0; xi < im_width; xi++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT max=WIDTH
+                #pragma HLS LOOP_FLATTEN off
+
+                // the pixel one line and one pixel before, which is the center of
+                // the window of HystThresholdComp (same position as its output)
+                int xs = xi - 1;
+                int ys = yi - 1;
+                if(xi == 0) {
+                    xs = im_width - 1;
+                    ys = yi - 2;
+                }
+                const CompLabel label = (ys < 0) ? 0 : label_buf[xs + ys*WIDTH];
+
+                // output
+                dst[xi + yi*WIDTH] = label_strong[label_root[label]] ? 0xFF : 0;
             }
         }
     }
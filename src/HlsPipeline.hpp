@@ -0,0 +1,586 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef SRC_HLS_PIPELINE_HPP_
+#define SRC_HLS_PIPELINE_HPP_
+
+#include <stdint.h>
+
+#include <type_traits>
+
+#include "HlsImProc.hpp"
+#ifndef __SYNTHESIS__
+#include <vector>
+
+#include "HlsDataflowSim.hpp"
+#endif
+
+namespace hlsimproc {
+    // run-time arguments of the stages of a Pipeline (each stage takes the ones it needs)
+    struct StageArgs {
+        uint32_t width;
+        uint32_t height;
+        uint8_t  hthr;
+        uint8_t  lthr;
+        uint32_t padding_size;
+        // window of the input frame processed by the ROI and stripe stages (width x height pixels at (win_x, win_y)
+        // of the frame_width x frame_height frame, win_x < 0 for the first stripe) and the ROI output from it
+        // (roi_width x roi_height pixels at (roi_x, roi_y) of the window), set by RoiStageArgs()/StripeStageArgs()
+        // and unused by the other stages
+        uint32_t frame_width;
+        uint32_t frame_height;
+        int32_t  win_x;
+        int32_t  win_y;
+        uint32_t roi_x;
+        uint32_t roi_y;
+        uint32_t roi_width;
+        uint32_t roi_height;
+        // line stride in pixels of the frame buffers of the memory-mapped stages (Mem2GrayArrayStage,
+        // GrayArray2MemStage and their stripe versions, unused by the other stages)
+        uint32_t src_stride;
+        uint32_t dst_stride;
+        // registers of the adaptive thresholds (HystThresholdAdaptiveStage, unused by the other stages):
+        // hthr/lthr from the histogram of the previous frame when hist_auto, hist_pct / 256 percentile
+        // and hist_ratio / 256 of it
+        bool     hist_auto;
+        uint8_t  hist_pct;
+        uint8_t  hist_ratio;
+    };
+
+    // arguments of the ROI stages for the roi_width x roi_height output at (roi_x, roi_y) of the frame
+    // (clamped to the frame): the window adds halo columns at the left of the ROI, up to halo rows at its
+    // top and up to margin columns/rows at its right/bottom, so that the ROI is processed as in the frame.
+    // A window left of the frame takes the end of the line above (win_x < 0, as the line buffers of the stages
+    // wrap around in the frame); when that would make it wider than the frame, it spans whole lines instead
+    inline StageArgs RoiStageArgs(uint32_t roi_x, uint32_t roi_y, uint32_t roi_width, uint32_t roi_height,
+                                  uint32_t frame_width, uint32_t frame_height, uint32_t halo, uint32_t margin,
+                                  uint8_t hthr, uint8_t lthr, uint32_t padding_size) {
+        const uint32_t x = (roi_x < frame_width) ? roi_x : frame_width;
+        const uint32_t y = (roi_y < frame_height) ? roi_y : frame_height;
+        const uint32_t w = (roi_width < frame_width - x) ? roi_width : frame_width - x;
+        const uint32_t h = (roi_height < frame_height - y) ? roi_height : frame_height - y;
+        uint32_t margin_x = (margin < frame_width - x - w) ? margin : frame_width - x - w;
+        const uint32_t margin_y = (margin < frame_height - y - h) ? margin : frame_height - y - h;
+
+        StageArgs args;
+        args.frame_width  = frame_width;
+        args.frame_height = frame_height;
+        if(halo + w + margin_x <= frame_width) {
+            args.win_x = int32_t(x) - int32_t(halo);
+        }
+        else {
+            args.win_x = 0;
+            margin_x   = frame_width - x - w;
+        }
+        args.win_y        = (y > halo) ? y - halo : 0;
+        args.roi_x        = x - args.win_x;
+        args.roi_y        = y - args.win_y;
+        args.roi_width    = w;
+        args.roi_height   = h;
+        args.width        = args.roi_x + w + margin_x;
+        args.height       = args.roi_y + h + margin_y;
+        args.hthr         = hthr;
+        args.lthr         = lthr;
+        args.padding_size = padding_size;
+        return args;
+    }
+
+    // arguments of the stripe stages for the output columns x to x + stripe_width - 1 of the frame (clamped to
+    // the frame): the window adds halo columns at the left of the stripe (left of the frame for the first
+    // stripe) and up to margin columns at its right, and spans every line of the frame
+    inline StageArgs StripeStageArgs(uint32_t x, uint32_t stripe_width, uint32_t frame_width, uint32_t frame_height,
+                                     uint32_t halo, uint32_t margin, uint8_t hthr, uint8_t lthr, uint32_t padding_size,
+                                     uint32_t src_stride, uint32_t dst_stride) {
+        const uint32_t w = (stripe_width < frame_width - x) ? stripe_width : frame_width - x;
+        const uint32_t margin_x = (margin < frame_width - x - w) ? margin : frame_width - x - w;
+
+        StageArgs args;
+        args.frame_width  = frame_width;
+        args.frame_height = frame_height;
+        args.win_x        = int32_t(x) - int32_t(halo);
+        args.win_y        = 0;
+        args.roi_x        = halo;
+        args.roi_y        = 0;
+        args.roi_width    = w;
+        args.roi_height   = frame_height;
+        args.width        = halo + w + margin_x;
+        args.height       = frame_height;
+        args.hthr         = hthr;
+        args.lthr         = lthr;
+        args.padding_size = padding_size;
+        args.src_stride   = src_stride;
+        args.dst_stride   = dst_stride;
+        return args;
+    }
+
+    // SIDE-th of the side channels passed to Pipeline::Run() (by reference, so a stage gets the array
+    // of the top function itself)
+    template<int SIDE>
+    struct SideChannel {
+        template<typename FIRST_T, typename... REST_T>
+        static auto Get(FIRST_T&, REST_T&... rest) -> decltype(SideChannel<SIDE - 1>::Get(rest...)) {
+            #pragma HLS INLINE
+            return SideChannel<SIDE - 1>::Get(rest...);
+        }
+    };
+
+    template<>
+    struct SideChannel<0> {
+        template<typename FIRST_T, typename... REST_T>
+        static FIRST_T& Get(FIRST_T& first, REST_T&...) {
+            #pragma HLS INLINE
+            return first;
+        }
+    };
+
+    //-- stages of a Pipeline: a HlsImProc stage with its template arguments bound.
+    //   SrcBeat/DstBeat are the elements it reads/writes, BEATS is the number of beats of
+    //   the largest frame (size of the array to the next stage) and Run() calls the stage.
+    //   A stage that also reads or writes an array of the top function (a copy of its stream for a stage
+    //   further on or for a DATAFLOW process after the Pipeline, a table kept between frames, a register)
+    //   takes it as side channel SIDE: the side channels are passed after args to Pipeline::Run() and
+    //   go to every stage by reference, so the array is an argument of the HlsImProc stage in the DATAFLOW
+    //   region as if the top function called it (and the STREAM directive of the top function applies to it)
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC, typename SRC_BEAT, typename DST_BEAT>
+    struct StageTypes {
+        typedef SRC_BEAT SrcBeat;
+        typedef DST_BEAT DstBeat;
+        static const uint32_t BEATS = WIDTH / PPC * HEIGHT;
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1>
+    struct AXIS2GrayArrayStage : StageTypes<WIDTH, HEIGHT, PPC, ImAxis<24, PPC>, PixBeat<uint8_t, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::AXIS2GrayArray<WIDTH, HEIGHT, PPC>(src, dst, args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT>
+    struct AXIS2GrayArrayRoiStage : StageTypes<WIDTH, HEIGHT, 1, ImAxis<24>, PixBeat<uint8_t, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::AXIS2GrayArrayRoi<WIDTH, HEIGHT>(src, dst, args.win_x, args.win_y, args.width, args.height,
+                                                        args.frame_width, args.frame_height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT>
+    struct Mem2GrayArrayStage : StageTypes<WIDTH, HEIGHT, 1, uint32_t, PixBeat<uint8_t, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::Mem2GrayArray<WIDTH, HEIGHT>(src, dst, args.src_stride, args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT>
+    struct Mem2GrayArrayStripeStage : StageTypes<WIDTH, HEIGHT, 1, uint32_t, PixBeat<uint8_t, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::Mem2GrayArrayStripe<WIDTH, HEIGHT>(src, dst, args.src_stride, args.win_x, args.width, args.height,
+                                                          args.frame_width);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, int KSIZE = 5, int SIGMA_X100 = 0>
+    struct GaussianBlurStage : StageTypes<WIDTH, HEIGHT, PPC, PixBeat<uint8_t, PPC>, PixBeat<uint8_t, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::GaussianBlur<WIDTH, HEIGHT, PPC, KSIZE, SIGMA_X100>(src, dst, args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1, MagMode MAG = MAG_EXACT>
+    struct SobelStage : StageTypes<WIDTH, HEIGHT, PPC, PixBeat<uint8_t, PPC>, PixBeat<GradPix, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::Sobel<WIDTH, HEIGHT, PPC, MAG>(src, dst, args.width, args.height);
+        }
+    };
+
+    // Sobel that also writes the signed gradient to the side channel SIDE
+    template<uint32_t WIDTH, uint32_t HEIGHT, int SIDE>
+    struct SobelXYStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, PixBeat<GradPix, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::SobelXY<WIDTH, HEIGHT>(src, dst, SideChannel<SIDE>::Get(side...), args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1>
+    struct NonMaxSuppressionStage : StageTypes<WIDTH, HEIGHT, PPC, PixBeat<GradPix, PPC>, PixBeat<uint8_t, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::NonMaxSuppression<WIDTH, HEIGHT, PPC>(src, dst, args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1>
+    struct ZeroPaddingStage : StageTypes<WIDTH, HEIGHT, PPC, PixBeat<uint8_t, PPC>, PixBeat<uint8_t, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::ZeroPadding<WIDTH, HEIGHT, PPC>(src, dst, args.padding_size, args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1>
+    struct ZeroPaddingRoiStage : StageTypes<WIDTH, HEIGHT, PPC, PixBeat<uint8_t, PPC>, PixBeat<uint8_t, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::ZeroPaddingRoi<WIDTH, HEIGHT, PPC>(src, dst, args.padding_size, args.win_x, args.win_y,
+                                                          args.width, args.height, args.frame_width, args.frame_height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1>
+    struct HystThresholdStage : StageTypes<WIDTH, HEIGHT, PPC, PixBeat<uint8_t, PPC>, PixBeat<uint8_t, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::HystThreshold<WIDTH, HEIGHT, PPC>(src, dst, args.hthr, args.lthr, args.width, args.height);
+        }
+    };
+
+    // HystThresholdStage by the histogram of the previous frame in the side channel SIDE
+    template<uint32_t WIDTH, uint32_t HEIGHT, int SIDE>
+    struct HystThresholdAdaptiveStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, PixBeat<uint8_t, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::HystThresholdAdaptive<WIDTH, HEIGHT>(src, dst, SideChannel<SIDE>::Get(side...),
+                                                            args.hthr, args.lthr, args.hist_auto, args.hist_pct,
+                                                            args.hist_ratio, args.padding_size, args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1>
+    struct HystThresholdCompStage : StageTypes<WIDTH, HEIGHT, PPC, PixBeat<uint8_t, PPC>, PixBeat<uint8_t, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::HystThresholdComp<WIDTH, HEIGHT, PPC>(src, dst, args.width, args.height);
+        }
+    };
+
+    // full hysteresis in place of HystThresholdCompStage (same delay): HystLabel and HystResolve are two
+    // DATAFLOW processes on the frame of labels, the equivalence table and the strong flags of the labels
+    // in the side channels SIDE to SIDE + 2 (ping-pong buffers, as the first process writes them and the second
+    // one reads them), and the overflow flag of HystLabel is the side channel SIDE + 3
+    template<uint32_t WIDTH, uint32_t HEIGHT, uint32_t MAX_LABELS, int SIDE>
+    struct HystTrackStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, PixBeat<uint8_t, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::HystLabel<WIDTH, HEIGHT, MAX_LABELS>(src, SideChannel<SIDE>::Get(side...),
+                                                            SideChannel<SIDE + 1>::Get(side...),
+                                                            SideChannel<SIDE + 2>::Get(side...),
+                                                            SideChannel<SIDE + 3>::Get(side...),
+                                                            args.width, args.height);
+            HlsImProc::HystResolve<WIDTH, HEIGHT, MAX_LABELS>(SideChannel<SIDE>::Get(side...),
+                                                              SideChannel<SIDE + 1>::Get(side...),
+                                                              SideChannel<SIDE + 2>::Get(side...),
+                                                              dst, args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT, int PPC = 1>
+    struct GrayArray2AXISStage : StageTypes<WIDTH, HEIGHT, PPC, PixBeat<uint8_t, PPC>, ImAxis<24, PPC> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::GrayArray2AXIS<WIDTH, HEIGHT, PPC>(src, dst, args.width, args.height);
+        }
+    };
+
+    // GrayArray2AXISStage, and the signed gradient of the side channel SIDE (written by SobelXYStage)
+    // to the AXI4-Stream of the side channel SIDE + 1 in step with it
+    template<uint32_t WIDTH, uint32_t HEIGHT, int SIDE>
+    struct GradArray2AXISStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, ImAxis<24> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::GrayArray2AXIS<WIDTH, HEIGHT>(src, dst, args.width, args.height);
+            HlsImProc::GradArray2AXIS<WIDTH, HEIGHT>(SideChannel<SIDE>::Get(side...), SideChannel<SIDE + 1>::Get(side...),
+                                                     args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT>
+    struct GrayArray2AXISRoiStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, ImAxis<24> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::GrayArray2AXISRoi<WIDTH, HEIGHT>(src, dst, args.roi_x, args.roi_y, args.roi_width, args.roi_height,
+                                                        args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT>
+    struct GrayArray2MemStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, uint8_t> {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::GrayArray2Mem<WIDTH, HEIGHT>(src, dst, args.dst_stride, args.width, args.height);
+        }
+    };
+
+    template<uint32_t WIDTH, uint32_t HEIGHT>
+    struct GrayArray2MemStripeStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, uint8_t> {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&...) {
+            #pragma HLS INLINE
+            HlsImProc::GrayArray2MemStripe<WIDTH, HEIGHT>(src, dst, args.dst_stride, args.roi_x, args.roi_width,
+                                                          args.width, args.height);
+        }
+    };
+
+    // CRCs of the tiles of the previous frame in the side channel SIDE and change map of the tiles
+    // in the side channel SIDE + 1
+    template<uint32_t WIDTH, uint32_t HEIGHT, uint32_t TILE_W, uint32_t TILE_H, int SIDE>
+    struct GrayTileChangeStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, PixBeat<uint8_t, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::GrayTileChange<WIDTH, HEIGHT, TILE_W, TILE_H>(src, dst, SideChannel<SIDE>::Get(side...),
+                                                                     SideChannel<SIDE + 1>::Get(side...),
+                                                                     args.width, args.height);
+        }
+    };
+
+    // copy of the image, and its 2:1 decimation in both directions (WIDTH / 2 x HEIGHT / 2 frame) to the side
+    // channel SIDE for the next level of a pyramid
+    template<uint32_t WIDTH, uint32_t HEIGHT, int SIDE>
+    struct DecimateStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, PixBeat<uint8_t, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::Decimate<WIDTH, HEIGHT>(src, dst, SideChannel<SIDE>::Get(side...), args.width, args.height);
+        }
+    };
+
+    // copy of the gradient to the side channel SIDE
+    template<uint32_t WIDTH, uint32_t HEIGHT, int SIDE>
+    struct GradTapStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<GradPix, 1>, PixBeat<GradPix, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::Duplicate<WIDTH, HEIGHT, GradPix>(src, dst, SideChannel<SIDE>::Get(side...),
+                                                         args.width, args.height);
+        }
+    };
+
+    // copy of the edge image to the side channel SIDE
+    template<uint32_t WIDTH, uint32_t HEIGHT, int SIDE>
+    struct EdgeTapStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, PixBeat<uint8_t, 1> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::Duplicate<WIDTH, HEIGHT, uint8_t>(src, dst, SideChannel<SIDE>::Get(side...),
+                                                         args.width, args.height);
+        }
+    };
+
+    // edge pixels with the gradient of the side channel SIDE (written by GradTapStage)
+    template<uint32_t WIDTH, uint32_t HEIGHT, int SIDE>
+    struct EdgeArray2AXISSparseStage : StageTypes<WIDTH, HEIGHT, 1, PixBeat<uint8_t, 1>, ImAxis<32> > {
+        template<typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            HlsImProc::EdgeArray2AXISSparse<WIDTH, HEIGHT>(src, SideChannel<SIDE>::Get(side...), dst,
+                                                           args.width, args.height);
+        }
+    };
+
+    // src/dst side of an hls::stream between two stages of Pipeline::RunFrames()
+    // (index is ignored, access is in raster order)
+    template<typename T>
+    class StreamLinkSrc {
+        public:
+        explicit StreamLinkSrc(hls::stream<T>& link) : link_(link) {}
+        T operator[](uint32_t) const {
+            return link_.read();
+        }
+
+        private:
+        hls::stream<T>& link_;
+    };
+
+    template<typename T>
+    class StreamLinkDst {
+        public:
+        class Ref {
+            public:
+            explicit Ref(hls::stream<T>& link) : link_(link) {}
+            Ref& operator=(const T& value) {
+                link_.write(value);
+                return *this;
+            }
+
+            private:
+            hls::stream<T>& link_;
+        };
+
+        explicit StreamLinkDst(hls::stream<T>& link) : link_(link) {}
+        Ref operator[](uint32_t) const {
+            return Ref(link_);
+        }
+
+        private:
+        hls::stream<T>& link_;
+    };
+
+    // DATAFLOW process of a stage that loops over num_frames frames by itself
+    // (the stages clear their line/window buffers while the first line of a frame shifts in,
+    //  so nothing has to be flushed between two frames)
+    template<typename STAGE, typename SRC_T, typename DST_T>
+    void RunStageFrames(SRC_T& src, DST_T& dst, const StageArgs& args, uint32_t num_frames) {
+        #pragma HLS INLINE off
+        for(uint32_t f = 0; f < num_frames; f++) {
+            #pragma HLS LOOP_TRIPCOUNT max=1
+            STAGE::Run(src, dst, args);
+        }
+    }
+
+    // chain of stages as DATAFLOW processes: the array between two stages is declared
+    // with the output type of the first one (checked against the input of the next one at
+    // compile time) and mapped to a DEPTH deep FIFO, so a chain is written as
+    //
+    //   struct MyTopLinks;  // tag of the arrays of the top function
+    //   typedef Pipeline<AXIS2GrayArrayStage<W, H>, GaussianBlurStage<W, H>, ..., GrayArray2AXISStage<W, H> > P;
+    //   P::Run<DEPTH, MyTopLinks>(axis_in, axis_out, args);  // in a function with "#pragma HLS DATAFLOW"
+    //
+    // (the side channels of the stages follow args: P::Run<DEPTH, MyTopLinks>(axis_in, axis_out, args, tap))
+    // (the arrays are static variables of Run<DEPTH, TAG>: each top function passes its own TAG type,
+    //  so tops that use the same Pipeline type get their own FIFOs instead of sharing one set of them)
+    //
+    // RunFrames() links the stages by hls::stream instead and runs each one over num_frames frames
+    // (RunStageFrames), so a stage starts the next frame as soon as it has finished one
+    template<typename... STAGES>
+    struct Pipeline;
+
+    template<typename LAST>
+    struct Pipeline<LAST> {
+        typedef typename LAST::SrcBeat SrcBeat;
+        typedef typename LAST::DstBeat DstBeat;
+        static const int NUM_LINKS = 0;
+
+        template<uint32_t DEPTH, typename TAG, typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            LAST::Run(src, dst, args, side...);
+        }
+
+        template<uint32_t DEPTH, typename TAG, typename SRC_T, typename DST_T>
+        static void RunFrames(SRC_T& src, DST_T& dst, const StageArgs& args, uint32_t num_frames) {
+            #pragma HLS INLINE
+            RunStageFrames<LAST>(src, dst, args, num_frames);
+        }
+
+#ifndef __SYNTHESIS__
+        template<uint32_t DEPTH, typename SRC_T, typename DST_T>
+        static void RunDataflow(DataflowRegion& region, SRC_T& src, DST_T& dst, const StageArgs& args,
+                                uint32_t num_frames, FifoStats* link_stats, std::vector<uint64_t>* out_cycles) {
+            region.Spawn([&] {
+                RunStageFrames<LAST>(src, dst, args, num_frames);
+            });
+            region.Join();
+        }
+#endif
+    };
+
+    template<typename FIRST, typename... REST>
+    struct Pipeline<FIRST, REST...> {
+        typedef typename FIRST::SrcBeat SrcBeat;
+        typedef typename Pipeline<REST...>::DstBeat DstBeat;
+        typedef typename FIRST::DstBeat LinkBeat;
+        static const int NUM_LINKS = 1 + Pipeline<REST...>::NUM_LINKS;
+
+        static_assert(std::is_same<LinkBeat, typename Pipeline<REST...>::SrcBeat>::value,
+                      "the output of a Pipeline stage must be the input of the next stage");
+
+        template<uint32_t DEPTH, typename TAG, typename SRC_T, typename DST_T, typename... SIDE_T>
+        static void Run(SRC_T& src, DST_T& dst, const StageArgs& args, SIDE_T&... side) {
+            #pragma HLS INLINE
+            static LinkBeat fifo[FIRST::BEATS];
+            #pragma HLS DATA_PACK variable=fifo
+            #pragma HLS STREAM variable=fifo depth=DEPTH dim=1
+
+            FIRST::Run(src, fifo, args, side...);
+            Pipeline<REST...>::template Run<DEPTH, TAG>(fifo, dst, args, side...);
+        }
+
+        template<uint32_t DEPTH, typename TAG, typename SRC_T, typename DST_T>
+        static void RunFrames(SRC_T& src, DST_T& dst, const StageArgs& args, uint32_t num_frames) {
+            #pragma HLS INLINE
+            static hls::stream<LinkBeat> link;
+            #pragma HLS DATA_PACK variable=link
+            #pragma HLS STREAM variable=link depth=DEPTH
+            StreamLinkDst<LinkBeat> link_dst(link);
+            StreamLinkSrc<LinkBeat> link_src(link);
+
+            RunStageFrames<FIRST>(src, link_dst, args, num_frames);
+            Pipeline<REST...>::template RunFrames<DEPTH, TAG>(link_src, dst, args, num_frames);
+        }
+
+#ifndef __SYNTHESIS__
+        // C simulation of RunFrames() with every stage on its own thread of region, linked by DEPTH deep
+        // SPSC FIFOs with a cycle model instead of hls::stream.
+        // statistics of the links are stored to link_stats[0..NUM_LINKS-1] if it is not NULL,
+        // and the modelled cycle of every read of the last link is appended to out_cycles if it is not NULL
+        template<uint32_t DEPTH, typename SRC_T, typename DST_T>
+        static void RunDataflow(DataflowRegion& region, SRC_T& src, DST_T& dst, const StageArgs& args,
+                                uint32_t num_frames, FifoStats* link_stats, std::vector<uint64_t>* out_cycles) {
+            SpscFifo<LinkBeat, DEPTH> link;
+            FifoWriter<SpscFifo<LinkBeat, DEPTH> > link_dst = WritePort(link);
+            FifoReader<SpscFifo<LinkBeat, DEPTH> > link_src = ReadPort(link);
+            if(NUM_LINKS == 1) {
+                link.SetReadLog(out_cycles);
+            }
+
+            region.Spawn([&] {
+                RunStageFrames<FIRST>(src, link_dst, args, num_frames);
+            });
+            // the last stage joins every thread before the links go out of scope
+            Pipeline<REST...>::template RunDataflow<DEPTH>(region, link_src, dst, args, num_frames,
+                                                           (link_stats == NULL) ? NULL : link_stats + 1, out_cycles);
+
+            if(link_stats != NULL) {
+                link_stats[0] = link.stats();
+            }
+        }
+#endif
+    };
+}
+
+#endif /* SRC_HLS_PIPELINE_HPP_ */
@@ -0,0 +1,297 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "HostCannyEngine.hpp"
+#include "HostCannyKernels.hpp"
+
+namespace hlsimproc {
+    namespace {
+        // smallest strip worth its halo (the halo is about 10 rows)
+        const uint32_t MIN_STRIP_ROWS = 16;
+        // strips per thread, so that stealing can balance uneven strips
+        const uint32_t STRIPS_PER_THREAD = 4;
+        // tile size of the incremental mode
+        const uint32_t DEFAULT_TILE_SIZE = 32;
+
+        // per-thread intermediate images of one strip (reused between strips)
+        struct StripScratch {
+            std::vector<uint8_t> gray;
+            std::vector<uint8_t> gauss;
+            std::vector<uint8_t> mag;
+            std::vector<uint8_t> dir;
+            std::vector<uint8_t> nms;
+            std::vector<uint8_t> hyst;
+
+            void Resize(size_t len) {
+                gray.resize(len);
+                gauss.resize(len);
+                mag.resize(len);
+                dir.resize(len);
+                nms.resize(len);
+                hyst.resize(len);
+            }
+        };
+    }
+
+    HostCannyEngine::HostCannyEngine(uint32_t num_threads)
+        : pool_(num_threads), strip_rows_(0), tile_width_(DEFAULT_TILE_SIZE), tile_height_(DEFAULT_TILE_SIZE),
+          inc_valid_(false), inc_width_(0), inc_height_(0), inc_hthr_(0), inc_lthr_(0), inc_pad_(0) {
+    }
+
+    void HostCannyEngine::Process(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t height,
+                                  uint8_t hthr, uint8_t lthr, PerfCounters* perf) {
+        uint32_t strip_rows = strip_rows_;
+        if(strip_rows == 0) {
+            const uint32_t num_strips = pool_.NumThreads() * STRIPS_PER_THREAD;
+            strip_rows = std::max(MIN_STRIP_ROWS, (height + num_strips - 1) / num_strips);
+        }
+        const uint32_t num_strips = (height + strip_rows - 1) / strip_rows;
+
+        pool_.ParallelFor(num_strips, [&](uint32_t strip) {
+            const uint32_t y_begin = strip * strip_rows;
+            const uint32_t y_end   = std::min(height, y_begin + strip_rows);
+            ProcessStrip(src, dst, width, height, y_begin, y_end, hthr, lthr);
+        });
+
+        if(perf != NULL) {
+            perf->frames++;
+            perf->edge_pixels = std::count(dst, dst + size_t(width) * height, uint8_t(0xFF));
+        }
+    }
+
+    void HostCannyEngine::ProcessStrip(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t height,
+                                       uint32_t y_begin, uint32_t y_end, uint8_t hthr, uint8_t lthr) {
+        static thread_local StripScratch scratch;
+
+        const int64_t begin = int64_t(y_begin) * width;
+        const int64_t end   = int64_t(y_end) * width;
+
+        // first pixel each stage has to produce for this strip (nothing before the frame)
+        const int64_t comp_begin  = begin;
+        const int64_t hyst_begin  = std::max<int64_t>(0, comp_begin - HystCompFootprint(width));
+        const int64_t grad_begin  = std::max<int64_t>(0, hyst_begin - NmsFootprint(width));
+        const int64_t gauss_begin = std::max<int64_t>(0, grad_begin - SobelFootprint(width));
+        const int64_t gray_begin  = std::max<int64_t>(0, gauss_begin - GaussFootprint(width));
+
+        // buffer index 0 is pixel "base", pixels before the frame stay zero (cleared line buffers)
+        const int64_t base = begin - CannyFootprint(width);
+        scratch.Resize(end - base);
+        if(base < 0) {
+            std::fill(scratch.gray.begin(), scratch.gray.begin() - base, 0);
+            std::fill(scratch.gauss.begin(), scratch.gauss.begin() - base, 0);
+            std::fill(scratch.mag.begin(), scratch.mag.begin() - base, 0);
+            std::fill(scratch.dir.begin(), scratch.dir.begin() - base, uint8_t(DIR_0));
+            std::fill(scratch.hyst.begin(), scratch.hyst.begin() - base, 0);
+        }
+
+        GrayScaleSpan(src + gray_begin, &scratch.gray[gray_begin - base], end - gray_begin);
+        GaussianBlurSpan(&scratch.gray[gauss_begin - base], &scratch.gauss[gauss_begin - base],
+                         end - gauss_begin, width);
+        SobelSpan(&scratch.gauss[grad_begin - base], &scratch.mag[grad_begin - base], &scratch.dir[grad_begin - base],
+                  grad_begin, end - grad_begin, width, height);
+        NonMaxSuppressionSpan(&scratch.mag[hyst_begin - base], &scratch.dir[hyst_begin - base],
+                              &scratch.nms[hyst_begin - base], hyst_begin, end - hyst_begin, width, height);
+        ZeroPaddingHystSpan(&scratch.nms[hyst_begin - base], &scratch.hyst[hyst_begin - base],
+                            hyst_begin, end - hyst_begin, width, height, PADDING_SIZE, hthr, lthr);
+        HystThresholdCompSpan(&scratch.hyst[comp_begin - base], dst + comp_begin, end - comp_begin, width);
+    }
+
+    void HostCannyEngine::SetTileSize(uint32_t tile_width, uint32_t tile_height) {
+        tile_width_  = std::max<uint32_t>(1, tile_width);
+        tile_height_ = std::max<uint32_t>(1, tile_height);
+        inc_valid_   = false;
+    }
+
+    void HostCannyEngine::ResizeIncremental(uint32_t width, uint32_t height) {
+        const uint32_t tiles_x = (width + tile_width_ - 1) / tile_width_;
+        const uint32_t tiles_y = (height + tile_height_ - 1) / tile_height_;
+
+        // pixels before the frame stay zero (cleared line buffers)
+        inc_pad_ = CannyFootprint(width);
+        const size_t len = inc_pad_ + size_t(width) * height;
+        inc_gray_.assign(len, 0);
+        inc_gauss_.assign(len, 0);
+        inc_mag_.assign(len, 0);
+        inc_dir_.assign(len, uint8_t(DIR_0));
+        inc_nms_.assign(len, 0);
+        inc_hyst_.assign(len, 0);
+        inc_edge_.assign(len, 0);
+        inc_changed_.assign(size_t(tiles_x) * tiles_y, 0);
+        inc_dirty_.assign(size_t(tiles_x) * tiles_y, 0);
+        inc_width_  = width;
+        inc_height_ = height;
+    }
+
+    void HostCannyEngine::ProcessIncremental(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t height,
+                                             uint8_t hthr, uint8_t lthr,
+                                             const uint8_t* tile_changed, IncrementalStats* stats) {
+        const uint32_t tw = tile_width_;
+        const uint32_t th = tile_height_;
+        const uint32_t tiles_x = (width + tw - 1) / tw;
+        const uint32_t tiles_y = (height + th - 1) / th;
+
+        // every tile is recomputed for the first frame, a new frame size or new thresholds
+        const bool resize = (width != inc_width_ || height != inc_height_ ||
+                             inc_changed_.size() != size_t(tiles_x) * tiles_y);
+        const bool full = (!inc_valid_ || resize || hthr != inc_hthr_ || lthr != inc_lthr_);
+        if(resize) {
+            ResizeIncremental(width, height);
+        }
+
+        uint8_t* gray  = &inc_gray_[inc_pad_];
+        uint8_t* gauss = &inc_gauss_[inc_pad_];
+        uint8_t* mag   = &inc_mag_[inc_pad_];
+        uint8_t* dir   = &inc_dir_[inc_pad_];
+        uint8_t* nms   = &inc_nms_[inc_pad_];
+        uint8_t* hyst  = &inc_hyst_[inc_pad_];
+        uint8_t* edge  = &inc_edge_[inc_pad_];
+
+        //-- grayscale frame and the changed tiles
+        pool_.ParallelFor(tiles_y, [&](uint32_t ty) {
+            static thread_local std::vector<uint8_t> line;
+            line.resize(width);
+
+            uint8_t* changed = &inc_changed_[size_t(ty) * tiles_x];
+            const uint32_t y_end = std::min(height, (ty + 1) * th);
+            if(tile_changed != NULL && !full) {
+                // the given map: only the changed tiles are converted
+                for(uint32_t tx = 0; tx < tiles_x; tx++) {
+                    changed[tx] = (tile_changed[tx + size_t(ty) * tiles_x] != 0);
+                }
+                for(uint32_t y = ty * th; y < y_end; y++) {
+                    for(uint32_t tx = 0; tx < tiles_x; tx++) {
+                        if(changed[tx]) {
+                            const int64_t p = int64_t(y) * width + tx * tw;
+                            GrayScaleSpan(src + p, gray + p, std::min(width, (tx + 1) * tw) - tx * tw);
+                        }
+                    }
+                }
+            }
+            else {
+                // compare each line of a tile with the previous frame
+                std::fill(changed, changed + tiles_x, uint8_t(full));
+                for(uint32_t y = ty * th; y < y_end; y++) {
+                    const int64_t p = int64_t(y) * width;
+                    GrayScaleSpan(src + p, line.data(), width);
+                    for(uint32_t tx = 0; tx < tiles_x; tx++) {
+                        const uint32_t x0 = tx * tw;
+                        if(!changed[tx] && memcmp(&line[x0], gray + p + x0, std::min(width, x0 + tw) - x0) != 0) {
+                            changed[tx] = 1;
+                        }
+                    }
+                    memcpy(gray + p, line.data(), width);
+                }
+            }
+        });
+
+        //-- tiles to recompute: an output reads the pixels up to "reach" pixels left of it and up to
+        //   "reach" lines above it, and the columns left of x = 0 come from the end of the previous line
+        const int64_t reach = CannyFootprint(width) / (int64_t(width) + 1);
+        std::fill(inc_dirty_.begin(), inc_dirty_.end(), 0);
+        auto mark = [&](int64_t x0, int64_t x1, int64_t y0, int64_t y1) {
+            for(int64_t ty = y0 / th; ty <= y1 / th; ty++) {
+                for(int64_t tx = x0 / tw; tx <= x1 / tw; tx++) {
+                    inc_dirty_[tx + ty * tiles_x] = 1;
+                }
+            }
+        };
+        uint32_t num_changed = 0;
+        for(uint32_t ty = 0; ty < tiles_y; ty++) {
+            for(uint32_t tx = 0; tx < tiles_x; tx++) {
+                if(!inc_changed_[tx + size_t(ty) * tiles_x]) {
+                    continue;
+                }
+                num_changed++;
+                const int64_t x0 = int64_t(tx) * tw;
+                const int64_t x1 = std::min<int64_t>(width, x0 + tw) - 1;
+                const int64_t y0 = int64_t(ty) * th;
+                const int64_t y1 = std::min<int64_t>(height - 1, std::min<int64_t>(height, y0 + th) - 1 + reach + 1);
+                mark(x0, std::min<int64_t>(width - 1, x1 + reach), y0, y1);
+                if(x1 + reach >= width) {
+                    mark(0, std::min<int64_t>(width - 1, x1 + reach - width), y0, y1);
+                }
+            }
+        }
+        const uint32_t num_dirty = uint32_t(std::count(inc_dirty_.begin(), inc_dirty_.end(), 1));
+
+        //-- stages on the runs of recomputed tiles of each line, one stage after the other
+        //   (the previous stage is up to date wherever the footprint of a recomputed pixel reaches)
+        auto for_dirty_spans = [&](const std::function<void(int64_t, int64_t)>& kernel) {
+            pool_.ParallelFor(tiles_y, [&](uint32_t ty) {
+                const uint8_t* dirty = &inc_dirty_[size_t(ty) * tiles_x];
+                const uint32_t y_end = std::min(height, (ty + 1) * th);
+                for(uint32_t y = ty * th; y < y_end; y++) {
+                    uint32_t tx = 0;
+                    while(tx < tiles_x) {
+                        if(!dirty[tx]) {
+                            tx++;
+                            continue;
+                        }
+                        uint32_t tx_end = tx + 1;
+                        while(tx_end < tiles_x && dirty[tx_end]) {
+                            tx_end++;
+                        }
+                        const int64_t x0 = int64_t(tx) * tw;
+                        const int64_t x1 = std::min<int64_t>(width, int64_t(tx_end) * tw);
+                        kernel(int64_t(y) * width + x0, x1 - x0);
+                        tx = tx_end;
+                    }
+                }
+            });
+        };
+        if(num_dirty > 0) {
+            for_dirty_spans([&](int64_t p, int64_t n) {
+                GaussianBlurSpan(gray + p, gauss + p, n, width);
+            });
+            for_dirty_spans([&](int64_t p, int64_t n) {
+                SobelSpan(gauss + p, mag + p, dir + p, p, n, width, height);
+            });
+            for_dirty_spans([&](int64_t p, int64_t n) {
+                NonMaxSuppressionSpan(mag + p, dir + p, nms + p, p, n, width, height);
+            });
+            for_dirty_spans([&](int64_t p, int64_t n) {
+                ZeroPaddingHystSpan(nms + p, hyst + p, p, n, width, height, PADDING_SIZE, hthr, lthr);
+            });
+            for_dirty_spans([&](int64_t p, int64_t n) {
+                HystThresholdCompSpan(hyst + p, edge + p, n, width);
+            });
+        }
+        memcpy(dst, edge, size_t(width) * height);
+
+        inc_valid_ = true;
+        inc_hthr_  = hthr;
+        inc_lthr_  = lthr;
+        if(stats != NULL) {
+            stats->tiles            = tiles_x * tiles_y;
+            stats->changed_tiles    = num_changed;
+            stats->recomputed_tiles = num_dirty;
+        }
+    }
+}
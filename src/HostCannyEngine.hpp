@@ -0,0 +1,128 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2019 Yuya Kudo.
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SRC_HOST_CANNY_ENGINE_HPP_
+#define SRC_HOST_CANNY_ENGINE_HPP_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "HlsImProc.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace hlsimproc {
+    // tiles of the last HostCannyEngine::ProcessIncremental()
+    struct IncrementalStats {
+        uint32_t tiles;            // tiles of the frame
+        uint32_t changed_tiles;    // tiles whose grayscale pixels changed
+        uint32_t recomputed_tiles; // tiles recomputed (changed tiles and the tiles their footprint reaches)
+    };
+
+    // multi-core host implementation of canny_edge_detection()
+    // the frame is split into horizontal strips which are processed in parallel;
+    // each strip recomputes the rows above it that are covered by the footprint of
+    // GaussianBlur, Sobel, NonMaxSuppression and HystThresholdComp (halo), so the result
+    // is bit-exact with the HlsImProc stages for any strip size
+    class HostCannyEngine {
+        public:
+        // zero padding size at boundary pixel (same as canny_edge_detection())
+        static const uint32_t PADDING_SIZE = 5;
+
+        // num_threads = 0 : use all hardware threads
+        explicit HostCannyEngine(uint32_t num_threads = 0);
+
+        uint32_t NumThreads() const {
+            return pool_.NumThreads();
+        }
+
+        // rows per strip (0 : chosen from frame height and number of threads)
+        void SetStripRows(uint32_t strip_rows) {
+            strip_rows_ = strip_rows;
+        }
+
+        // src : 24bit AXI4-Stream data of each pixel in raster order (as fed to canny_edge_detection())
+        // dst : edge map (0 or 0xFF), the value carried on every channel of axis_out
+        // perf : counters as of canny_edge_detection_perf() if it is not NULL (frames and edge_pixels;
+        //        the frame comes from memory, so there are no input beats or stalls to count)
+        void Process(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t height,
+                     uint8_t hthr, uint8_t lthr, PerfCounters* perf = NULL);
+
+        //-- incremental mode for static cameras: the grayscale frame is compared with the previous one
+        //   tile by tile, and the stages are recomputed only for the changed tiles and the tiles that
+        //   the footprint of the pipeline reaches from them (ten pixels right and down); the other tiles
+        //   keep the intermediate images and the edge map of the previous frame. The output is the same
+        //   as Process(), and every tile is recomputed when the frame size or the thresholds change
+        // tile size of the incremental mode (default 32 x 32)
+        void SetTileSize(uint32_t tile_width, uint32_t tile_height);
+
+        // tile_changed : change map of the grayscale tiles (tile tx + ty*tiles_x non-zero when changed,
+        //                tiles_x = ceil(width / tile width), e.g. from canny_edge_detection_tiles())
+        //                used instead of comparing the frame, NULL : compare with the previous frame
+        void ProcessIncremental(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t height,
+                                uint8_t hthr, uint8_t lthr,
+                                const uint8_t* tile_changed = NULL, IncrementalStats* stats = NULL);
+
+        // change map of the grayscale tiles of the last ProcessIncremental()
+        const uint8_t* TileChanged() const {
+            return inc_changed_.data();
+        }
+
+        // forget the previous frame (the next ProcessIncremental() recomputes every tile)
+        void ResetIncremental() {
+            inc_valid_ = false;
+        }
+
+        private:
+        void ProcessStrip(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t height,
+                          uint32_t y_begin, uint32_t y_end, uint8_t hthr, uint8_t lthr);
+
+        void ResizeIncremental(uint32_t width, uint32_t height);
+
+        WorkStealingPool pool_;
+        uint32_t strip_rows_;
+
+        //-- state of the incremental mode: the images of every stage of the previous frame,
+        //   each one behind inc_pad_ pixels of cleared line buffer
+        uint32_t tile_width_;
+        uint32_t tile_height_;
+        bool inc_valid_;
+        uint32_t inc_width_;
+        uint32_t inc_height_;
+        uint8_t inc_hthr_;
+        uint8_t inc_lthr_;
+        int64_t inc_pad_;
+        std::vector<uint8_t> inc_gray_;
+        std::vector<uint8_t> inc_gauss_;
+        std::vector<uint8_t> inc_mag_;
+        std::vector<uint8_t> inc_dir_;
+        std::vector<uint8_t> inc_nms_;
+        std::vector<uint8_t> inc_hyst_;
+        std::vector<uint8_t> inc_edge_;
+        std::vector<uint8_t> inc_changed_;   // grayscale tiles changed
+        std::vector<uint8_t> inc_dirty_;     // tiles recomputed
+    };
+}
+
+#endif /* SRC_HOST_CANNY_ENGINE_HPP_ */
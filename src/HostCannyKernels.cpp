@@ -0,0 +1,315 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <math.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "HostCannyKernels.hpp"
+#include "HostCannyKernelsSimd.hpp"
+
+namespace hlsimproc {
+    namespace scalar {
+        void FillBorder(uint8_t* dst, int64_t p0, int64_t n, uint32_t width, uint32_t height,
+                        uint32_t border, uint8_t value) {
+            const int64_t w = width;
+            const int64_t h = height;
+            const int64_t b = border;
+
+            int64_t i = 0;
+            while(i < n) {
+                const int64_t p   = p0 + i;
+                const int64_t xi  = p % w;
+                const int64_t yi  = p / w;
+                // rest of this line within the span
+                const int64_t len = std::min(w - xi, n - i);
+
+                if(!(b < yi && yi < h - b)) {
+                    for(int64_t k = 0; k < len; k++) {
+                        dst[i + k] = value;
+                    }
+                }
+                else {
+                    for(int64_t k = 0; k < len; k++) {
+                        if(!(b < xi + k && xi + k < w - b)) {
+                            dst[i + k] = value;
+                        }
+                    }
+                }
+                i += len;
+            }
+        }
+
+        void GaussianBlurSpan(const uint8_t* src, uint8_t* dst, int64_t n, uint32_t width) {
+            // separable 1-4-6-4-1 passes (same integer sum as the 5x5 kernel of HlsImProc::GaussianBlur)
+            const int KERNEL_SIZE = 5;
+            const int GAUSS_COEF[KERNEL_SIZE] = {1, 4, 6, 4, 1};
+            const int CHUNK = 512;
+            const int64_t w = width;
+            int vsum[CHUNK + KERNEL_SIZE - 1];
+
+            for(int64_t c = 0; c < n; c += CHUNK) {
+                const int m = int(std::min<int64_t>(CHUNK, n - c));
+
+                // vertical sums of the columns of pixel c - 4 ... c + m - 1
+                const uint8_t* s = src + c - (KERNEL_SIZE - 1);
+                for(int j = 0; j < m + KERNEL_SIZE - 1; j++) {
+                    int v = 0;
+                    for(int yw = 0; yw < KERNEL_SIZE; yw++) {
+                        v += s[j - (KERNEL_SIZE - 1 - yw)*w] * GAUSS_COEF[yw];
+                    }
+                    vsum[j] = v;
+                }
+
+                // horizontal pass
+                for(int k = 0; k < m; k++) {
+                    int pix_gauss = 0;
+                    for(int xw = 0; xw < KERNEL_SIZE; xw++) {
+                        pix_gauss += vsum[k + xw] * GAUSS_COEF[xw];
+                    }
+                    dst[c + k] = pix_gauss >> 8;
+                }
+            }
+        }
+
+        void SobelSpan(const uint8_t* src, uint8_t* mag, uint8_t* dir,
+                       int64_t p0, int64_t n, uint32_t width, uint32_t height) {
+            const int KERNEL_SIZE = 3;
+            const int64_t w = width;
+
+            for(int64_t i = 0; i < n; i++) {
+                const uint8_t* r0 = src + i - 2*w - 2;
+                const uint8_t* r1 = src + i - w - 2;
+                const uint8_t* r2 = src + i - 2;
+
+                // same kernels as HlsImProc::Sobel
+                const int pix_h_sobel = (r0[0] - r0[2]) + 2*(r1[0] - r1[2]) + (r2[0] - r2[2]);
+                const int pix_v_sobel = (r0[0] + 2*r0[1] + r0[2]) - (r2[0] + 2*r2[1] + r2[2]);
+
+                int pix_sobel = sqrtf(float(pix_h_sobel * pix_h_sobel + pix_v_sobel * pix_v_sobel));
+                if(255 < pix_sobel) {
+                    pix_sobel = 255;
+                }
+
+                // direction classified by cross multiplication as HlsImProc::SobelPix
+                // (gx = 0 falls through to DIR_90)
+                const int n_dir = (pix_h_sobel < 0) ? -pix_v_sobel * 256 : pix_v_sobel * 256;
+                const int d_dir = (pix_h_sobel < 0) ? -pix_h_sobel : pix_h_sobel;
+
+                GradDir grad_sobel;
+                if(-d_dir*618 < n_dir && n_dir <= -d_dir*106) {
+                    grad_sobel = DIR_135;
+                }
+                else if(-d_dir*106 < n_dir && n_dir < d_dir*107) {
+                    grad_sobel = DIR_0;
+                }
+                else if(d_dir*107 <= n_dir && n_dir < d_dir*618) {
+                    grad_sobel = DIR_45;
+                }
+                else {
+                    grad_sobel = DIR_90;
+                }
+
+                mag[i] = pix_sobel;
+                dir[i] = grad_sobel;
+            }
+            FillBorder(mag, p0, n, width, height, KERNEL_SIZE, 0);
+        }
+
+        void NonMaxSuppressionSpan(const uint8_t* mag, const uint8_t* dir, uint8_t* dst,
+                                   int64_t p0, int64_t n, uint32_t width, uint32_t height) {
+            const int WINDOW_SIZE = 3;
+            const int64_t w = width;
+
+            for(int64_t i = 0; i < n; i++) {
+                const uint8_t* r0 = mag + i - 2*w - 2;
+                const uint8_t* r1 = mag + i - w - 2;
+                const uint8_t* r2 = mag + i - 2;
+
+                // same neighbours as HlsImProc::NonMaxSuppression (window_buf[row][col] = r<row>[col])
+                uint8_t value_nms = r1[1];
+                const uint8_t grad_nms = dir[i - w - 1];
+                if(grad_nms == DIR_0) {
+                    if(value_nms < r1[0] || value_nms < r1[2]) {
+                        value_nms = 0;
+                    }
+                }
+                else if(grad_nms == DIR_45) {
+                    if(value_nms < r0[0] || value_nms < r2[2]) {
+                        value_nms = 0;
+                    }
+                }
+                else if(grad_nms == DIR_90) {
+                    if(value_nms < r0[2] || value_nms < r2[1]) {
+                        value_nms = 0;
+                    }
+                }
+                else if(grad_nms == DIR_135) {
+                    if(value_nms < r2[0] || value_nms < r0[2]) {
+                        value_nms = 0;
+                    }
+                }
+                dst[i] = value_nms;
+            }
+            FillBorder(dst, p0, n, width, height, WINDOW_SIZE, 0);
+        }
+
+        void ZeroPaddingHystSpan(const uint8_t* src, uint8_t* dst, int64_t p0, int64_t n,
+                                 uint32_t width, uint32_t height,
+                                 uint32_t padding_size, uint8_t hthr, uint8_t lthr) {
+            for(int64_t i = 0; i < n; i++) {
+                const uint8_t pix = src[i];
+                if(pix < lthr) {
+                    dst[i] = 0;
+                }
+                else if(pix > hthr) {
+                    dst[i] = 255;
+                }
+                else {
+                    dst[i] = 1;
+                }
+            }
+            // padded pixels are 0 before the threshold (weak only if lthr = 0)
+            const uint8_t pad_hyst = (0 < lthr) ? 0 : 1;
+            FillBorder(dst, p0, n, width, height, padding_size, pad_hyst);
+        }
+
+        void HystThresholdCompSpan(const uint8_t* src, uint8_t* dst, int64_t n, uint32_t width) {
+            const int64_t w = width;
+
+            for(int64_t i = 0; i < n; i++) {
+                const uint8_t* r0 = src + i - 2*w - 2;
+                const uint8_t* r1 = src + i - w - 2;
+                const uint8_t* r2 = src + i - 2;
+
+                uint8_t pix_hyst = 0;
+                if(r1[1] != 0) {
+                    if(r0[0] == 0xFF || r0[1] == 0xFF || r0[2] == 0xFF ||
+                       r1[0] == 0xFF || r1[1] == 0xFF || r1[2] == 0xFF ||
+                       r2[0] == 0xFF || r2[1] == 0xFF || r2[2] == 0xFF) {
+                        pix_hyst = 0xFF;
+                    }
+                }
+                dst[i] = pix_hyst;
+            }
+        }
+    }
+
+    namespace {
+        SimdLevel DetectSimdLevel() {
+#ifdef HLSIMPROC_X86_SIMD
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx2")) {
+                return SIMD_AVX2;
+            }
+            if(__builtin_cpu_supports("sse4.1")) {
+                return SIMD_SSE41;
+            }
+#endif
+            return SIMD_NONE;
+        }
+
+        std::atomic<int> simd_level(-1);
+
+        SimdLevel CurrentLevel() {
+            int level = simd_level.load(std::memory_order_relaxed);
+            if(level < 0) {
+                level = SupportedSimdLevel();
+                simd_level.store(level, std::memory_order_relaxed);
+            }
+            return SimdLevel(level);
+        }
+    }
+
+    SimdLevel SupportedSimdLevel() {
+        static const SimdLevel supported = DetectSimdLevel();
+        return supported;
+    }
+
+    void SetSimdLevel(SimdLevel level) {
+        simd_level.store(std::min(level, SupportedSimdLevel()), std::memory_order_relaxed);
+    }
+
+    SimdLevel GetSimdLevel() {
+        return CurrentLevel();
+    }
+
+#ifdef HLSIMPROC_X86_SIMD
+#define HLSIMPROC_DISPATCH(func, args)         \
+    switch(CurrentLevel()) {                   \
+        case SIMD_AVX2:  avx2::func args; break;  \
+        case SIMD_SSE41: sse41::func args; break; \
+        default:         scalar::func args; break; \
+    }
+#else
+#define HLSIMPROC_DISPATCH(func, args) scalar::func args;
+#endif
+
+    void GrayScaleSpan(const uint32_t* src, uint8_t* dst, int64_t n) {
+        for(int64_t i = 0; i < n; i++) {
+            const uint32_t data = src[i] & 0xffffff;
+
+            // Y = B*0.144 + G*0.587 + R*0.299
+            int pix_gray = 9437*(data & 0x0000ff)
+                + 38469*((data & 0x00ff00) >> 8 )
+                + 19595*((data & 0xff0000) >> 16);
+
+            pix_gray >>= 16;
+
+            // to consider saturation
+            if(pix_gray < 0) {
+                pix_gray = 0;
+            }
+            else if(pix_gray > 255) {
+                pix_gray = 255;
+            }
+
+            dst[i] = pix_gray;
+        }
+    }
+
+    void GaussianBlurSpan(const uint8_t* src, uint8_t* dst, int64_t n, uint32_t width) {
+        HLSIMPROC_DISPATCH(GaussianBlurSpan, (src, dst, n, width))
+    }
+
+    void SobelSpan(const uint8_t* src, uint8_t* mag, uint8_t* dir,
+                   int64_t p0, int64_t n, uint32_t width, uint32_t height) {
+        HLSIMPROC_DISPATCH(SobelSpan, (src, mag, dir, p0, n, width, height))
+    }
+
+    void NonMaxSuppressionSpan(const uint8_t* mag, const uint8_t* dir, uint8_t* dst,
+                               int64_t p0, int64_t n, uint32_t width, uint32_t height) {
+        HLSIMPROC_DISPATCH(NonMaxSuppressionSpan, (mag, dir, dst, p0, n, width, height))
+    }
+
+    void ZeroPaddingHystSpan(const uint8_t* src, uint8_t* dst, int64_t p0, int64_t n, uint32_t width, uint32_t height,
+                             uint32_t padding_size, uint8_t hthr, uint8_t lthr) {
+        HLSIMPROC_DISPATCH(ZeroPaddingHystSpan, (src, dst, p0, n, width, height, padding_size, hthr, lthr))
+    }
+
+    void HystThresholdCompSpan(const uint8_t* src, uint8_t* dst, int64_t n, uint32_t width) {
+        HLSIMPROC_DISPATCH(HystThresholdCompSpan, (src, dst, n, width))
+    }
+}
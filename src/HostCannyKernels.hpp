@@ -0,0 +1,86 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2019 Yuya Kudo.
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SRC_HOST_CANNY_KERNELS_HPP_
+#define SRC_HOST_CANNY_KERNELS_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "HlsImProc.hpp"
+
+// Host (CPU) kernels bit-exact with the HlsImProc stages.
+//
+// A HlsImProc stage sees the frame as one raster ordered stream: its window at pixel
+// p = x + y*width holds the input pixels p - dy*width - dx, so the columns left of x = 0
+// come from the end of the previous line, and everything before p = 0 is the cleared
+// line/window buffer (zero). Each kernel below computes n outputs starting at pixel p0
+// with exactly that rule. src and dst point to the elements of pixel p0, and src must be
+// readable back to the footprint of the stage (pixels before the frame must hold zero).
+//
+// The output of Sobel (GradPix) is kept as two planes, magnitude and GradDir (uint8_t),
+// so that every kernel works on byte lanes. Each kernel uses the widest SIMD instruction
+// set available on the running CPU (see SetSimdLevel()).
+namespace hlsimproc {
+    // number of pixels each stage reads behind the current pixel
+    inline int64_t GaussFootprint(uint32_t width) { return 4 * (int64_t(width) + 1); }
+    inline int64_t SobelFootprint(uint32_t width) { return 2 * (int64_t(width) + 1); }
+    inline int64_t NmsFootprint(uint32_t width) { return 2 * (int64_t(width) + 1); }
+    inline int64_t HystCompFootprint(uint32_t width) { return 2 * (int64_t(width) + 1); }
+    // whole pipeline (ZeroPadding/HystThreshold are point operations)
+    inline int64_t CannyFootprint(uint32_t width) {
+        return GaussFootprint(width) + SobelFootprint(width) + NmsFootprint(width) + HystCompFootprint(width);
+    }
+
+    // instruction set used by the kernels
+    enum SimdLevel {
+        SIMD_NONE,
+        SIMD_SSE41,
+        SIMD_AVX2
+    };
+
+    // best instruction set of the running CPU
+    SimdLevel SupportedSimdLevel();
+    // select the instruction set (clamped to SupportedSimdLevel(), which is the default)
+    void SetSimdLevel(SimdLevel level);
+    SimdLevel GetSimdLevel();
+
+    // AXIS2GrayArray : 24bit AXI4-Stream data -> grayscale
+    void GrayScaleSpan(const uint32_t* src, uint8_t* dst, int64_t n);
+    // GaussianBlur
+    void GaussianBlurSpan(const uint8_t* src, uint8_t* dst, int64_t n, uint32_t width);
+    // Sobel (needs p0 and height for the boundary mask)
+    void SobelSpan(const uint8_t* src, uint8_t* mag, uint8_t* dir,
+                   int64_t p0, int64_t n, uint32_t width, uint32_t height);
+    // NonMaxSuppression
+    void NonMaxSuppressionSpan(const uint8_t* mag, const uint8_t* dir, uint8_t* dst,
+                               int64_t p0, int64_t n, uint32_t width, uint32_t height);
+    // ZeroPadding + HystThreshold
+    void ZeroPaddingHystSpan(const uint8_t* src, uint8_t* dst, int64_t p0, int64_t n, uint32_t width, uint32_t height,
+                             uint32_t padding_size, uint8_t hthr, uint8_t lthr);
+    // HystThresholdComp
+    void HystThresholdCompSpan(const uint8_t* src, uint8_t* dst, int64_t n, uint32_t width);
+}
+
+#endif /* SRC_HOST_CANNY_KERNELS_HPP_ */
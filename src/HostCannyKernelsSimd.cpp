@@ -0,0 +1,151 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "HostCannyKernels.hpp"
+#include "HostCannyKernelsSimd.hpp"
+
+#ifdef HLSIMPROC_X86_SIMD
+
+#include <algorithm>
+
+#include <immintrin.h>
+
+// the kernels are built for each instruction set inside a target region, so this file
+// needs no special compiler flags and runs on any x86 CPU (see SupportedSimdLevel())
+#if defined(__clang__)
+#define HLSIMPROC_TARGET_BEGIN(isa) \
+    _Pragma("clang attribute push(__attribute__((target(" #isa "))), apply_to = function)")
+#define HLSIMPROC_TARGET_END _Pragma("clang attribute pop")
+#else
+#define HLSIMPROC_PRAGMA(x) _Pragma(#x)
+#define HLSIMPROC_TARGET_BEGIN(isa) \
+    _Pragma("GCC push_options") HLSIMPROC_PRAGMA(GCC target(isa))
+#define HLSIMPROC_TARGET_END _Pragma("GCC pop_options")
+#endif
+
+HLSIMPROC_TARGET_BEGIN("sse4.1")
+namespace hlsimproc {
+    namespace sse41 {
+        // 128bit vector operations used by HostCannyKernelsSimd.inc
+        struct Ops {
+            typedef __m128i V;
+            static const int LANES8  = 16;  // uint8_t lanes
+            static const int LANES16 = 8;   // int16_t lanes
+
+            static inline V Zero() { return _mm_setzero_si128(); }
+            static inline V Set8(int x) { return _mm_set1_epi8(char(x)); }
+            static inline V Set16(int x) { return _mm_set1_epi16(short(x)); }
+            static inline V Set32(int x) { return _mm_set1_epi32(x); }
+            static inline V Load(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+            static inline void Store(void* p, V v) { _mm_storeu_si128(static_cast<__m128i*>(p), v); }
+            // LANES16 bytes <-> 16bit lanes (values must be 0..255 to store)
+            static inline V LoadU8ToU16(const uint8_t* p) {
+                return _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+            }
+            static inline void StoreU16ToU8(uint8_t* p, V v) {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(v, v));
+            }
+
+            static inline V Add16(V a, V b) { return _mm_add_epi16(a, b); }
+            static inline V Sub16(V a, V b) { return _mm_sub_epi16(a, b); }
+            static inline V Shl1x16(V a) { return _mm_slli_epi16(a, 1); }
+            static inline V Shl2x16(V a) { return _mm_slli_epi16(a, 2); }
+            static inline V Shr8x16(V a) { return _mm_srli_epi16(a, 8); }
+            static inline V Sign16(V a, V b) { return _mm_sign_epi16(a, b); }
+            static inline V Abs16(V a) { return _mm_abs_epi16(a); }
+            static inline V UnpackLo16(V a, V b) { return _mm_unpacklo_epi16(a, b); }
+            static inline V UnpackHi16(V a, V b) { return _mm_unpackhi_epi16(a, b); }
+            static inline V Madd16(V a, V b) { return _mm_madd_epi16(a, b); }
+            static inline V Packs32(V a, V b) { return _mm_packs_epi32(a, b); }
+            static inline V CmpGt32(V a, V b) { return _mm_cmpgt_epi32(a, b); }
+            static inline V Min32(V a, V b) { return _mm_min_epi32(a, b); }
+            static inline V SqrtTrunc32(V a) { return _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(a))); }
+
+            static inline V MaxU8(V a, V b) { return _mm_max_epu8(a, b); }
+            static inline V MinU8(V a, V b) { return _mm_min_epu8(a, b); }
+            static inline V CmpEq8(V a, V b) { return _mm_cmpeq_epi8(a, b); }
+            static inline V And(V a, V b) { return _mm_and_si128(a, b); }
+            static inline V AndNot(V a, V b) { return _mm_andnot_si128(a, b); }
+            static inline V Blend8(V a, V b, V mask) { return _mm_blendv_epi8(a, b, mask); }
+        };
+
+#include "HostCannyKernelsSimd.inc"
+    }
+}
+HLSIMPROC_TARGET_END
+
+HLSIMPROC_TARGET_BEGIN("avx2")
+namespace hlsimproc {
+    namespace avx2 {
+        // 256bit vector operations used by HostCannyKernelsSimd.inc
+        // (unpack/madd/packs work within 128bit lanes, and the pair restores the pixel order)
+        struct Ops {
+            typedef __m256i V;
+            static const int LANES8  = 32;  // uint8_t lanes
+            static const int LANES16 = 16;  // int16_t lanes
+
+            static inline V Zero() { return _mm256_setzero_si256(); }
+            static inline V Set8(int x) { return _mm256_set1_epi8(char(x)); }
+            static inline V Set16(int x) { return _mm256_set1_epi16(short(x)); }
+            static inline V Set32(int x) { return _mm256_set1_epi32(x); }
+            static inline V Load(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+            static inline void Store(void* p, V v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+            // LANES16 bytes <-> 16bit lanes (values must be 0..255 to store)
+            static inline V LoadU8ToU16(const uint8_t* p) {
+                return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            }
+            static inline void StoreU16ToU8(uint8_t* p, V v) {
+                const V packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+            }
+
+            static inline V Add16(V a, V b) { return _mm256_add_epi16(a, b); }
+            static inline V Sub16(V a, V b) { return _mm256_sub_epi16(a, b); }
+            static inline V Shl1x16(V a) { return _mm256_slli_epi16(a, 1); }
+            static inline V Shl2x16(V a) { return _mm256_slli_epi16(a, 2); }
+            static inline V Shr8x16(V a) { return _mm256_srli_epi16(a, 8); }
+            static inline V Sign16(V a, V b) { return _mm256_sign_epi16(a, b); }
+            static inline V Abs16(V a) { return _mm256_abs_epi16(a); }
+            static inline V UnpackLo16(V a, V b) { return _mm256_unpacklo_epi16(a, b); }
+            static inline V UnpackHi16(V a, V b) { return _mm256_unpackhi_epi16(a, b); }
+            static inline V Madd16(V a, V b) { return _mm256_madd_epi16(a, b); }
+            static inline V Packs32(V a, V b) { return _mm256_packs_epi32(a, b); }
+            static inline V CmpGt32(V a, V b) { return _mm256_cmpgt_epi32(a, b); }
+            static inline V Min32(V a, V b) { return _mm256_min_epi32(a, b); }
+            static inline V SqrtTrunc32(V a) { return _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(a))); }
+
+            static inline V MaxU8(V a, V b) { return _mm256_max_epu8(a, b); }
+            static inline V MinU8(V a, V b) { return _mm256_min_epu8(a, b); }
+            static inline V CmpEq8(V a, V b) { return _mm256_cmpeq_epi8(a, b); }
+            static inline V And(V a, V b) { return _mm256_and_si256(a, b); }
+            static inline V AndNot(V a, V b) { return _mm256_andnot_si256(a, b); }
+            static inline V Blend8(V a, V b, V mask) { return _mm256_blendv_epi8(a, b, mask); }
+        };
+
+#include "HostCannyKernelsSimd.inc"
+    }
+}
+HLSIMPROC_TARGET_END
+
+#endif /* HLSIMPROC_X86_SIMD */
@@ -0,0 +1,68 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2019 Yuya Kudo.
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SRC_HOST_CANNY_KERNELS_SIMD_HPP_
+#define SRC_HOST_CANNY_KERNELS_SIMD_HPP_
+
+// per instruction set implementations behind HostCannyKernels.hpp (internal)
+
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HLSIMPROC_X86_SIMD 1
+#endif
+
+#define HLSIMPROC_DECLARE_SPAN_KERNELS                                                              \
+    void GaussianBlurSpan(const uint8_t* src, uint8_t* dst, int64_t n, uint32_t width);            \
+    void SobelSpan(const uint8_t* src, uint8_t* mag, uint8_t* dir,                                  \
+                   int64_t p0, int64_t n, uint32_t width, uint32_t height);                         \
+    void NonMaxSuppressionSpan(const uint8_t* mag, const uint8_t* dir, uint8_t* dst,                \
+                               int64_t p0, int64_t n, uint32_t width, uint32_t height);             \
+    void ZeroPaddingHystSpan(const uint8_t* src, uint8_t* dst, int64_t p0, int64_t n,               \
+                             uint32_t width, uint32_t height,                                       \
+                             uint32_t padding_size, uint8_t hthr, uint8_t lthr);                    \
+    void HystThresholdCompSpan(const uint8_t* src, uint8_t* dst, int64_t n, uint32_t width);
+
+namespace hlsimproc {
+    namespace scalar {
+        HLSIMPROC_DECLARE_SPAN_KERNELS
+
+        // dst[i] = value for every pixel p0 + i that is not strictly inside the frame by border
+        // (the boundary mask of Sobel, NonMaxSuppression and ZeroPadding)
+        void FillBorder(uint8_t* dst, int64_t p0, int64_t n, uint32_t width, uint32_t height,
+                        uint32_t border, uint8_t value);
+    }
+
+#ifdef HLSIMPROC_X86_SIMD
+    namespace sse41 {
+        HLSIMPROC_DECLARE_SPAN_KERNELS
+    }
+
+    namespace avx2 {
+        HLSIMPROC_DECLARE_SPAN_KERNELS
+    }
+#endif
+}
+
+#endif /* SRC_HOST_CANNY_KERNELS_SIMD_HPP_ */
@@ -0,0 +1,139 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "WorkStealingPool.hpp"
+
+namespace hlsimproc {
+    WorkStealingPool::WorkStealingPool(uint32_t num_threads)
+        : num_threads_(num_threads), task_(NULL), generation_(0), pending_(0), stop_(false) {
+        if(num_threads_ == 0) {
+            num_threads_ = std::thread::hardware_concurrency();
+        }
+        if(num_threads_ == 0) {
+            num_threads_ = 1;
+        }
+
+        for(uint32_t i = 0; i < num_threads_; i++) {
+            queues_.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+        }
+        // worker 0 is the thread that calls ParallelFor()
+        for(uint32_t i = 1; i < num_threads_; i++) {
+            threads_.push_back(std::thread(&WorkStealingPool::WorkerLoop, this, i));
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        wake_cv_.notify_all();
+        for(size_t i = 0; i < threads_.size(); i++) {
+            threads_[i].join();
+        }
+    }
+
+    void WorkStealingPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task) {
+        if(count == 0) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            task_    = &task;
+            pending_ = count;
+            // contiguous chunk per worker (neighbouring tasks share cache lines of the frame)
+            for(uint32_t w = 0; w < num_threads_; w++) {
+                const uint32_t begin = uint64_t(count) * w / num_threads_;
+                const uint32_t end   = uint64_t(count) * (w + 1) / num_threads_;
+                std::lock_guard<std::mutex> qlock(queues_[w]->mtx);
+                for(uint32_t i = begin; i < end; i++) {
+                    queues_[w]->items.push_back(i);
+                }
+            }
+            generation_++;
+        }
+        wake_cv_.notify_all();
+
+        while(RunOne(0)) {
+        }
+
+        std::unique_lock<std::mutex> lock(mtx_);
+        done_cv_.wait(lock, [this] { return pending_ == 0; });
+        task_ = NULL;
+    }
+
+    void WorkStealingPool::WorkerLoop(uint32_t worker_id) {
+        uint64_t seen = 0;
+        while(true) {
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                wake_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if(stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+            while(RunOne(worker_id)) {
+            }
+        }
+    }
+
+    bool WorkStealingPool::RunOne(uint32_t worker_id) {
+        bool found = false;
+        uint32_t index = 0;
+
+        // own queue (LIFO end)
+        {
+            TaskQueue& q = *queues_[worker_id];
+            std::lock_guard<std::mutex> lock(q.mtx);
+            if(!q.items.empty()) {
+                index = q.items.back();
+                q.items.pop_back();
+                found = true;
+            }
+        }
+        // steal from the others (FIFO end)
+        for(uint32_t k = 1; !found && k < num_threads_; k++) {
+            TaskQueue& q = *queues_[(worker_id + k) % num_threads_];
+            std::lock_guard<std::mutex> lock(q.mtx);
+            if(!q.items.empty()) {
+                index = q.items.front();
+                q.items.pop_front();
+                found = true;
+            }
+        }
+        if(!found) {
+            return false;
+        }
+
+        (*task_)(index);
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        if(--pending_ == 0) {
+            done_cv_.notify_all();
+        }
+        return true;
+    }
+}
@@ -0,0 +1,81 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2019 Yuya Kudo.
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SRC_WORK_STEALING_POOL_HPP_
+#define SRC_WORK_STEALING_POOL_HPP_
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hlsimproc {
+    // thread pool with one task queue per worker
+    // (a worker pops its own queue from the back and steals from the front of the others)
+    class WorkStealingPool {
+        public:
+        // num_threads = 0 : use all hardware threads (the calling thread is one of the workers)
+        explicit WorkStealingPool(uint32_t num_threads = 0);
+        ~WorkStealingPool();
+
+        uint32_t NumThreads() const {
+            return num_threads_;
+        }
+
+        // run task(i) for 0 <= i < count and wait for all of them
+        // (consecutive indices are initially queued on the same worker)
+        void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task);
+
+        private:
+        WorkStealingPool(const WorkStealingPool&);
+        WorkStealingPool& operator=(const WorkStealingPool&);
+
+        struct TaskQueue {
+            std::mutex mtx;
+            std::deque<uint32_t> items;
+        };
+
+        void WorkerLoop(uint32_t worker_id);
+        bool RunOne(uint32_t worker_id);
+
+        uint32_t num_threads_;
+        std::vector<std::thread> threads_;
+        std::vector<std::unique_ptr<TaskQueue> > queues_;
+
+        std::mutex mtx_;
+        std::condition_variable wake_cv_;
+        std::condition_variable done_cv_;
+        const std::function<void(uint32_t)>* task_;
+        uint64_t generation_;
+        uint32_t pending_;
+        bool stop_;
+    };
+}
+
+#endif /* SRC_WORK_STEALING_POOL_HPP_ */
@@ -31,18 +31,247 @@ THE SOFTWARE.
 #include <ap_axi_sdata.h>
 
 #include "HlsImProc.hpp"
+#include "HlsPipeline.hpp"
+#ifndef __SYNTHESIS__
+#include <vector>
 
+#include "HlsDataflowSim.hpp"
+#endif
+
+// maximum frame size (sizes the buffers; the frame size is set at run time by
+// im_width/im_height and, for canny_edge_detection_ppc(), im_width must be
+// a multiple of PIXELS_PER_CLOCK)
 #define MAX_WIDTH  512
 #define MAX_HEIGHT 512
 
+// depth of FIFOs between DATAFLOW processes of canny_edge_detection()
+// (and of canny_edge_detection_csim_dataflow())
+#define FIFO_DEPTH 1
+#define NUM_FIFOS  7
+
+// size of the equivalence table of canny_edge_detection_hyst() (<= 65536)
+#define MAX_HYST_LABELS 16384
+
+// pixels per clock of canny_edge_detection_ppc() (2, 4 or 8, MAX_WIDTH must be a multiple of it)
+#define PIXELS_PER_CLOCK 4
+
+// time-multiplexed streams of canny_edge_detection_multi() and the TDEST width to address them
+#define MAX_STREAMS   4
+#define STREAM_DEST_W 2
+
+// bits per AXI4-Stream beat of canny_edge_detection_packed() (1 bit per pixel)
+#define PACKED_BEAT_W 64
+
+// depth of the FIFO that takes the Sobel gradient around the edge stages in canny_edge_detection_sparse()
+// (and canny_edge_detection_hough()/canny_edge_detection_grad())
+#define SPARSE_GRAD_DEPTH 64
+
+// Hough accumulator of canny_edge_detection_hough(): angle bins over 180° (4 sectors of GradDir),
+// rho bin = 1 << HOUGH_RHO_SHIFT pixels, and the number of peaks output at the end of each frame
+#define HOUGH_THETA_BINS 64
+#define HOUGH_RHO_SHIFT  1
+#define HOUGH_PEAKS      8
+
+// input pixel format of canny_edge_detection_luma() (hlsimproc::PixFormat)
+#define INPUT_FORMAT hlsimproc::PIX_YUV422
+
+// tiles compared with the previous frame by canny_edge_detection_tiles()
+// (and the tile size of HostCannyEngine::ProcessIncremental() for its change map)
+#define TILE_WIDTH  32
+#define TILE_HEIGHT 32
+#define MAX_TILES   (((MAX_WIDTH + TILE_WIDTH - 1) / TILE_WIDTH) * ((MAX_HEIGHT + TILE_HEIGHT - 1) / TILE_HEIGHT))
+
+// rows/columns of the input above/left of the ROI of canny_edge_detection_roi() that its output depends on
+// (the 5x5 GaussianBlur and the 3x3 Sobel, NonMaxSuppression and HystThresholdComp each reach
+//  2/1/1/1 pixels around the centre of the window and output it 2/1/1/1 pixels later),
+// and rows/columns below/right of it that keep the frame boundary of Sobel and NonMaxSuppression outside the ROI
+#define ROI_HALO   10
+#define ROI_MARGIN 3
+
+// vertical stripes of canny_edge_detection_stripes(): output columns per stripe and the largest frame.
+// Its stages process a window of STRIPE_WINDOW columns (ROI_HALO columns left of the stripe and ROI_MARGIN
+// right of it), so their line buffers are sized by STRIPE_WINDOW and not by the frame width
+#define STRIPE_WIDTH      128
+#define STRIPE_WINDOW     (STRIPE_WIDTH + ROI_HALO + ROI_MARGIN)
+#define STRIPE_MAX_WIDTH  8192
+#define STRIPE_MAX_HEIGHT 4320
+
+// stages of canny_edge_detection() between the AXI4-Streams (the FIFOs between them are declared by Pipeline)
+typedef hlsimproc::Pipeline<hlsimproc::AXIS2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT>,
+                            hlsimproc::GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                            hlsimproc::SobelStage<MAX_WIDTH, MAX_HEIGHT>,
+                            hlsimproc::NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                            hlsimproc::ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT>,
+                            hlsimproc::HystThresholdStage<MAX_WIDTH, MAX_HEIGHT>,
+                            hlsimproc::HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT>,
+                            hlsimproc::GrayArray2AXISStage<MAX_WIDTH, MAX_HEIGHT> > CannyPipeline;
+
+static_assert(CannyPipeline::NUM_LINKS == NUM_FIFOS, "NUM_FIFOS must be the number of FIFOs of CannyPipeline");
+
 //--- for test bench
 #define INPUT_IMAGE  "lenna.png"
 #define OUTPUT_IMAGE "out.png"
 #define CANNY_HTHR   80
 #define CANNY_LTHR   20
+#define CROP_WIDTH   320
+#define CROP_HEIGHT  240
+#define HIST_PCT     230 // 90% of the edge candidates are not strong
+#define HIST_RATIO   102 // low threshold = 0.4 * high threshold
 //---
 
 void canny_edge_detection(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
-                          uint8_t& hist_hthr, uint8_t& hist_lthr);
+                          uint8_t& hist_hthr, uint8_t& hist_lthr,
+                          uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection() with the filter stages fused into HlsImProc::CannyFused
+// (one line buffer and two DATAFLOW FIFOs instead of seven)
+void canny_edge_detection_fused(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                                uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection_fused() with the input in INPUT_FORMAT (Y8, YUV 4:2:2 or raw Bayer)
+// instead of 24bit RGB (HlsImProc::AXIS2LumaArray)
+void canny_edge_detection_luma(hls::stream<hlsimproc::ImAxis<hlsimproc::PixFormatBits<INPUT_FORMAT>::value> >& axis_in,
+                               hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                               uint8_t& hist_hthr, uint8_t& hist_lthr,
+                               uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection_fused() with the edge map packed to 1 bit per pixel,
+// PACKED_BEAT_W pixels per beat (HlsImProc::GrayArray2AXISPacked)
+void canny_edge_detection_packed(hls::stream<hlsimproc::ImAxis<24> >& axis_in,
+                                 hls::stream<hlsimproc::ImAxis<PACKED_BEAT_W> >& axis_out,
+                                 uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                 uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection() with only the edge pixels as (x, y, gradient direction)
+// and the number of them at end of frame (HlsImProc::EdgeArray2AXISSparse)
+void canny_edge_detection_sparse(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<32> >& axis_out,
+                                 uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                 uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection_sparse() with the edge map as canny_edge_detection() and, at end of frame,
+// the HOUGH_PEAKS strongest lines of it as (rho, theta, votes) on axis_lines (HlsImProc::HoughAccumulate)
+void canny_edge_detection_hough(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                                hls::stream<hlsimproc::ImAxis<32> >& axis_lines,
+                                uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection() with the signed Sobel gradient of every pixel on axis_grad in step with the edge map
+// on axis_out (beat i of both streams is the same pixel): data[15:0] : gx, data[31:16] : gy as int16
+// (HlsImProc::SobelXY and HlsImProc::GradArray2AXIS, zero at the boundary of the frame)
+void canny_edge_detection_grad(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                               hls::stream<hlsimproc::ImAxis<32> >& axis_grad,
+                               uint8_t& hist_hthr, uint8_t& hist_lthr,
+                               uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection() with a second level of a pyramid in the same DATAFLOW region: the GaussianBlur
+// output is also decimated 2:1 (HlsImProc::Decimate) and processed from Sobel to HystThresholdComp at half
+// resolution, so one pass over the input outputs the edge map of the frame on axis_out and the
+// (im_width / 2) x (im_height / 2) edge map of the half resolution frame on axis_out_half
+void canny_edge_detection_pyramid(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                                  hls::stream<hlsimproc::ImAxis<24> >& axis_out_half,
+                                  uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                  uint32_t& im_width, uint32_t& im_height);
+
+// canny_edge_detection_fused() shared by MAX_STREAMS sources interleaved line by line or frame by frame
+// (TDEST is the stream ID): one call handles one frame of every stream, each stream has its own
+// line/window buffer bank and thresholds (hist_hthr[i]/hist_lthr[i] for TDEST i), and the output lines
+// keep the TDEST of the input lines
+void canny_edge_detection_multi(hls::stream<hlsimproc::ImAxis<24, 1, STREAM_DEST_W> >& axis_in,
+                                hls::stream<hlsimproc::ImAxis<24, 1, STREAM_DEST_W> >& axis_out,
+                                uint8_t hist_hthr[MAX_STREAMS], uint8_t hist_lthr[MAX_STREAMS],
+                                uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection() with PIXELS_PER_CLOCK pixels in each AXI4-Stream beat
+// (every stage processes PIXELS_PER_CLOCK pixels per clock)
+void canny_edge_detection_ppc(hls::stream<hlsimproc::ImAxis<24, PIXELS_PER_CLOCK> >& axis_in,
+                              hls::stream<hlsimproc::ImAxis<24, PIXELS_PER_CLOCK> >& axis_out,
+                              uint8_t& hist_hthr, uint8_t& hist_lthr,
+                              uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection() with full hysteresis edge tracking
+// (weak pixels connected to a strong pixel through any chain of weak pixels are edges)
+// instead of HystThresholdComp, which looks only at the 3x3 neighbours. label_overflow is set
+// for a frame with more components than MAX_HYST_LABELS - 2 (the weak ones after that are dropped)
+void canny_edge_detection_hyst(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                               uint8_t& hist_hthr, uint8_t& hist_lthr,
+                               uint32_t& im_width, uint32_t& im_height, bool& label_overflow);
+
+// same as canny_edge_detection() with thresholds that follow the scene: the histogram of
+// the NMS magnitudes of each frame gives the thresholds of the next one
+// (hist_pct / 256 of the edge candidates are at most the high threshold, the low threshold is
+// hist_ratio / 256 of it), hist_hthr/hist_lthr are used while hist_auto is false
+void canny_edge_detection_adaptive(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                                   uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                   bool& hist_auto, uint8_t& hist_pct, uint8_t& hist_ratio,
+                                   uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection() for num_frames back-to-back frames in one call:
+// every DATAFLOW process loops over the frames by itself, so frame N+1 enters a process
+// as soon as frame N has left it (no drain of the whole pipeline between frames),
+// and the line/window buffers are cleared while the first line of each frame shifts in
+void canny_edge_detection_continuous(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                                     uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                     uint32_t& im_width, uint32_t& im_height, uint32_t& num_frames);
+
+// same as canny_edge_detection() with AXI4-Stream monitors at the input and the output:
+// perf (read-only registers on CONTROL_BUS) has the frames processed, the input beats discarded
+// while waiting for the start of frame, the short/long input lines, the clocks stalled on the input
+// (inside a frame) and on the output, all counted from reset, and the edge pixels of the last frame
+// (HlsImProc::AXISInMonitor/AXISOutMonitor)
+void canny_edge_detection_perf(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                               uint8_t& hist_hthr, uint8_t& hist_lthr,
+                               uint32_t& im_width, uint32_t& im_height, hlsimproc::PerfCounters& perf);
+
+// same as canny_edge_detection() for the roi_width x roi_height region at (roi_x, roi_y) of the output only:
+// the stages process the ROI with ROI_HALO input rows/columns above/left of it and ROI_MARGIN below/right of it
+// (fewer at the edges of the frame) and the output frame is the ROI, so the processing after the input and the output bandwidth
+// scale with the area of the ROI. The output is canny_edge_detection() cropped to the ROI: the window of a ROI
+// less than ROI_HALO pixels from the left edge of the frame starts each line with the end of the line above
+// (as the windows at the left edge of a line do in the frame), or spans whole lines if it would be wider than the frame
+void canny_edge_detection_roi(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                              uint8_t& hist_hthr, uint8_t& hist_lthr,
+                              uint32_t& im_width, uint32_t& im_height,
+                              uint32_t& roi_x, uint32_t& roi_y, uint32_t& roi_width, uint32_t& roi_height);
+
+// same as canny_edge_detection() with the change map of the grayscale frame against the previous call:
+// tile_changed[tx + ty*tiles_x] (tiles_x = ceil(im_width / TILE_WIDTH)) is 1 when the CRC-32 of the
+// TILE_WIDTH x TILE_HEIGHT tile has changed (HlsImProc::GrayTileChange), to be passed on to
+// HostCannyEngine::ProcessIncremental() or to write back only the changed part of the edge map
+void canny_edge_detection_tiles(hls::stream<hlsimproc::ImAxis<24> >& axis_in, hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                                uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                uint32_t& im_width, uint32_t& im_height, uint8_t tile_changed[MAX_TILES]);
+
+// same as canny_edge_detection() on frame buffers in memory instead of AXI4-Streams (m_axi masters, the base
+// addresses src_mem/dst_mem are s_axilite registers): num_frames frames of 32bit RGB pixels (bits as the AXI4-Stream data),
+// each im_height lines of src_stride pixels after the previous one, are read by bursts of one line and
+// their edge maps of 8bit pixels written in the same way with lines of dst_stride pixels
+// (the frames are processed one after another, the stages of a frame as DATAFLOW processes)
+void canny_edge_detection_mm(const uint32_t* src_mem, uint8_t* dst_mem,
+                             uint32_t& src_stride, uint32_t& dst_stride, uint32_t& num_frames,
+                             uint8_t& hist_hthr, uint8_t& hist_lthr,
+                             uint32_t& im_width, uint32_t& im_height);
+
+// same as canny_edge_detection_mm() for one frame of up to STRIPE_MAX_WIDTH x STRIPE_MAX_HEIGHT pixels,
+// processed as vertical stripes of STRIPE_WIDTH columns one after another: each stripe is read with the
+// columns its output depends on (HlsImProc::Mem2GrayArrayStripe) and written to its columns of the output
+// frame (HlsImProc::GrayArray2MemStripe), so the output is the same as of a full width pipeline
+void canny_edge_detection_stripes(const uint32_t* src_mem, uint8_t* dst_mem,
+                                  uint32_t& src_stride, uint32_t& dst_stride,
+                                  uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                  uint32_t& im_width, uint32_t& im_height);
+
+#ifndef __SYNTHESIS__
+// C simulation of canny_edge_detection_continuous() that runs each DATAFLOW process on its own thread,
+// linked by FIFO_DEPTH deep SPSC FIFOs instead of frame sized arrays
+// (statistics of the FIFOs are stored to link_stats[0..NUM_FIFOS-1] if it is not NULL,
+// and the modelled cycle of every output beat is appended to out_cycles if it is not NULL)
+void canny_edge_detection_csim_dataflow(hls::stream<hlsimproc::ImAxis<24> >& axis_in,
+                                        hls::stream<hlsimproc::ImAxis<24> >& axis_out,
+                                        uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                        uint32_t& im_width, uint32_t& im_height,
+                                        hlsimproc::FifoStats* link_stats = NULL, uint32_t num_frames = 1,
+                                        std::vector<uint64_t>* out_cycles = NULL);
+#endif
 
 #endif /* SRC_CANNY_EDGE_DETECTION_H_ */
@@ -0,0 +1,77 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// stages of canny_edge_detection() with the hysteresis thresholds from the histogram of the previous frame
+// (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<AXIS2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                 SobelStage<MAX_WIDTH, MAX_HEIGHT>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                 ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdAdaptiveStage<MAX_WIDTH, MAX_HEIGHT, 0>,
+                 HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GrayArray2AXISStage<MAX_WIDTH, MAX_HEIGHT> > CannyAdaptivePipeline;
+
+// tag of the FIFOs of CannyAdaptivePipeline in canny_edge_detection_adaptive()
+struct CannyAdaptiveLinks;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// histogram of the NMS magnitudes kept from frame to frame (side channel 0 of CannyAdaptivePipeline)
+static HystHistogram<> adaptive_hist;
+
+// Top Function
+void canny_edge_detection_adaptive(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_out,
+                                   uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                   bool& hist_auto, uint8_t& hist_pct, uint8_t& hist_ratio,
+                                   uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_auto bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_pct bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_ratio bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+
+    // AXI4-Stream -> GrayScale image -> gaussian bler -> sobel filter -> non-maximum suppression
+    // -> zero padding at boundary pixel -> hysteresis threshold by the histogram of the previous frame
+    // -> comparison operation at neighboring pixels -> AXI4-Stream
+    StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+    args.hist_auto  = hist_auto;
+    args.hist_pct   = hist_pct;
+    args.hist_ratio = hist_ratio;
+    CannyAdaptivePipeline::Run<FIFO_DEPTH, CannyAdaptiveLinks>(axis_in, axis_out, args, adaptive_hist);
+}
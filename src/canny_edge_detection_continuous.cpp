@@ -0,0 +1,58 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// tag of the FIFOs of CannyPipeline in canny_edge_detection_continuous()
+struct CannyContinuousLinks;
+
+// Top Function
+void canny_edge_detection_continuous(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_out,
+                                     uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                     uint32_t& im_width, uint32_t& im_height, uint32_t& num_frames) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=num_frames bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+
+    // registers are latched once for all the frames
+    const StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+
+    // every stage loops over the frames by itself and goes on to the next frame
+    // as soon as it has finished one (the FIFOs between them are declared by Pipeline)
+    CannyPipeline::RunFrames<FIFO_DEPTH, CannyContinuousLinks>(axis_in, axis_out, args, num_frames);
+}
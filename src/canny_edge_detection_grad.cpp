@@ -0,0 +1,76 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// stages of canny_edge_detection() with the signed gradient of SobelXY output in step with the edge map
+// (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<AXIS2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                 SobelXYStage<MAX_WIDTH, MAX_HEIGHT, 0>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                 ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GradArray2AXISStage<MAX_WIDTH, MAX_HEIGHT, 0> > CannyGradPipeline;
+
+// tag of the FIFOs of CannyGradPipeline in canny_edge_detection_grad()
+struct CannyGradLinks;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// gradient from SobelXYStage to GradArray2AXISStage (side channel 0 of CannyGradPipeline, axis_grad is 1)
+static GradXY grad_xy[MAX_WIDTH * MAX_HEIGHT];
+
+// Top Function
+void canny_edge_detection_grad(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_out,
+                               stream<ImAxis<32> >& axis_grad,
+                               uint8_t& hist_hthr, uint8_t& hist_lthr,
+                               uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE axis port=axis_grad
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+    // FIFO directive
+    // the gradient bypasses four stages, so it has to cover their pipeline latency
+    #pragma HLS STREAM variable=grad_xy depth=SPARSE_GRAD_DEPTH dim=1
+
+    // AXI4-Stream -> GrayScale image -> gaussian bler -> sobel filter (the signed gradient goes to its own output)
+    // -> non-maximum suppression -> zero padding at boundary pixel -> hysteresis threshold
+    // -> comparison operation at neighboring pixels -> AXI4-Stream, and gradient -> AXI4-Stream
+    // (delayed to the pixels of the edge map)
+    StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+    CannyGradPipeline::Run<FIFO_DEPTH, CannyGradLinks>(axis_in, axis_out, args, grad_xy, axis_grad);
+}
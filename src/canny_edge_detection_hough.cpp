@@ -0,0 +1,87 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// stages of canny_edge_detection() with taps of the gradient and of the edge image for HoughAccumulate
+// (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<AXIS2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                 SobelStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GradTapStage<MAX_WIDTH, MAX_HEIGHT, 0>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                 ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT>,
+                 EdgeTapStage<MAX_WIDTH, MAX_HEIGHT, 1>,
+                 GrayArray2AXISStage<MAX_WIDTH, MAX_HEIGHT> > CannyHoughPipeline;
+
+// tag of the FIFOs of CannyHoughPipeline in canny_edge_detection_hough()
+struct CannyHoughLinks;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// gradient and edge image from GradTapStage/EdgeTapStage (side channels 0 and 1 of CannyHoughPipeline)
+// to HoughAccumulate
+static GradPix hough_grad[MAX_WIDTH * MAX_HEIGHT];
+static uint8_t hough_edge[MAX_WIDTH * MAX_HEIGHT];
+
+// (rho, theta) votes of the current frame (cleared by HoughAccumulate at the end of each frame)
+static HoughAccumulator<MAX_WIDTH, MAX_HEIGHT, HOUGH_THETA_BINS, HOUGH_RHO_SHIFT> hough_acc;
+
+// Top Function
+void canny_edge_detection_hough(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_out,
+                                stream<ImAxis<32> >& axis_lines,
+                                uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE axis port=axis_lines
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+    // FIFO directive
+    // the gradient bypasses four stages, so it has to cover their pipeline latency
+    #pragma HLS STREAM variable=hough_grad depth=SPARSE_GRAD_DEPTH dim=1
+    #pragma HLS STREAM variable=hough_edge depth=1 dim=1
+
+    // AXI4-Stream -> GrayScale image -> gaussian bler -> sobel filter (the gradient direction also goes to
+    // the Hough stage) -> non-maximum suppression -> zero padding at boundary pixel -> hysteresis threshold
+    // -> comparison operation at neighboring pixels (the edge image also goes to the Hough stage) -> AXI4-Stream
+    StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+    CannyHoughPipeline::Run<FIFO_DEPTH, CannyHoughLinks>(axis_in, axis_out, args, hough_grad, hough_edge);
+
+    // edge pixels -> (rho, theta) votes -> AXI4-Stream of the strongest lines
+    HlsImProc::HoughAccumulate<MAX_WIDTH, MAX_HEIGHT, HOUGH_PEAKS>(hough_edge, hough_grad, hough_acc, axis_lines,
+                                                                   im_width, im_height);
+}
@@ -0,0 +1,77 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// stages of canny_edge_detection() with full hysteresis edge tracking in place of the comparison
+// at neighbouring pixels (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<AXIS2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                 SobelStage<MAX_WIDTH, MAX_HEIGHT>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                 ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystTrackStage<MAX_WIDTH, MAX_HEIGHT, MAX_HYST_LABELS, 0>,
+                 GrayArray2AXISStage<MAX_WIDTH, MAX_HEIGHT> > CannyHystPipeline;
+
+// tag of the FIFOs of CannyHystPipeline in canny_edge_detection_hyst()
+struct CannyHystLinks;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// frame of labels and equivalence table between the two passes (side channels 0 to 2 of CannyHystPipeline,
+// label_overflow is 3; ping-pong buffers, the second pass outputs a frame while the first one labels the next).
+// The labels of the whole frame are kept: a component is only known to have a strong pixel
+// at the end of the frame, when its first pixels may be at the top of it
+static CompLabel hyst_labels[MAX_WIDTH * MAX_HEIGHT];
+static CompLabel hyst_label_root[MAX_HYST_LABELS];
+static bool hyst_label_strong[MAX_HYST_LABELS];
+
+// Top Function
+void canny_edge_detection_hyst(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_out,
+                               uint8_t& hist_hthr, uint8_t& hist_lthr,
+                               uint32_t& im_width, uint32_t& im_height, bool& label_overflow) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=label_overflow bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+
+    // AXI4-Stream -> GrayScale image -> gaussian bler -> sobel filter -> non-maximum suppression
+    // -> zero padding at boundary pixel -> hysteresis threshold -> connected component labelling of
+    // weak/strong pixels -> edge tracking by the resolved labels -> AXI4-Stream
+    StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+    CannyHystPipeline::Run<FIFO_DEPTH, CannyHystLinks>(axis_in, axis_out, args, hyst_labels, hyst_label_root,
+                                                       hyst_label_strong, label_overflow);
+}
@@ -0,0 +1,61 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+static uint8_t luma_fifo1[MAX_WIDTH * MAX_HEIGHT];
+static uint8_t luma_fifo2[MAX_WIDTH * MAX_HEIGHT];
+
+// Top Function
+void canny_edge_detection_luma(stream<ImAxis<PixFormatBits<INPUT_FORMAT>::value> >& axis_in,
+                               stream<ImAxis<24> >& axis_out,
+                               uint8_t& hist_hthr, uint8_t& hist_lthr,
+                               uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+    // FIFO directive
+    #pragma HLS STREAM variable=luma_fifo1 depth=1 dim=1
+    #pragma HLS STREAM variable=luma_fifo2 depth=1 dim=1
+
+    // AXI4-Stream of INPUT_FORMAT -> GrayScale image
+    HlsImProc::AXIS2LumaArray<MAX_WIDTH, MAX_HEIGHT, INPUT_FORMAT>(axis_in, luma_fifo1, im_width, im_height);
+
+    // exe gaussian bler, sobel filter, non-maximum suppression, zero padding and hysteresis threshold
+    const uint32_t PADDING_SIZE = 5;
+    HlsImProc::CannyFused<MAX_WIDTH, MAX_HEIGHT>(luma_fifo1, luma_fifo2, hist_hthr, hist_lthr, PADDING_SIZE, im_width, im_height);
+
+    // GrayScale image -> AXI4-Stream
+    HlsImProc::GrayArray2AXIS<MAX_WIDTH, MAX_HEIGHT>(luma_fifo2, axis_out, im_width, im_height);
+}
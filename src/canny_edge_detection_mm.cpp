@@ -0,0 +1,87 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// stages of canny_edge_detection() between the frame buffers (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<Mem2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                 SobelStage<MAX_WIDTH, MAX_HEIGHT>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                 ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GrayArray2MemStage<MAX_WIDTH, MAX_HEIGHT> > CannyMmPipeline;
+
+// tag of the FIFOs of CannyMmPipeline in canny_edge_detection_mm()
+struct CannyMmLinks;
+
+// one frame (the DATAFLOW region the frame loop of the top function starts once per frame)
+static void canny_edge_detection_mm_frame(const uint32_t* src_frame, uint8_t* dst_frame, const StageArgs& args) {
+    #pragma HLS INLINE off
+    #pragma HLS DATAFLOW
+    CannyMmPipeline::Run<FIFO_DEPTH, CannyMmLinks>(src_frame, dst_frame, args);
+}
+
+// Top Function
+void canny_edge_detection_mm(const uint32_t* src_mem, uint8_t* dst_mem,
+                             uint32_t& src_stride, uint32_t& dst_stride, uint32_t& num_frames,
+                             uint8_t& hist_hthr, uint8_t& hist_lthr,
+                             uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE m_axi port=src_mem offset=slave bundle=SRC_BUS max_read_burst_length=256
+    #pragma HLS INTERFACE m_axi port=dst_mem offset=slave bundle=DST_BUS max_write_burst_length=256
+    #pragma HLS INTERFACE s_axilite port=src_mem bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=dst_mem bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=src_stride bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=dst_stride bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=num_frames bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    // started by the host for each batch of frames (ap_start/ap_done on CONTROL_BUS)
+    #pragma HLS INTERFACE s_axilite port=return bundle=CONTROL_BUS clock=s_axi_aclk
+
+    // registers are latched once per batch
+    StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+    args.src_stride = src_stride;
+    args.dst_stride = dst_stride;
+    const uint32_t frames = num_frames;
+
+    // memory -> GrayScale image -> gaussian bler -> sobel filter -> non-maximum suppression
+    // -> zero padding at boundary pixel -> hysteresis threshold
+    // -> comparison operation at neighboring pixels -> memory
+    for(uint32_t f = 0; f < frames; f++) {
+        #pragma HLS LOOP_TRIPCOUNT max=1
+        canny_edge_detection_mm_frame(src_mem + f*args.src_stride*args.height,
+                                      dst_mem + f*args.dst_stride*args.height, args);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// AXI4-Streams between the monitors and the stages
+static stream<ImAxis<24> > perf_axis_in;
+static stream<ImAxis<24> > perf_axis_out;
+
+// tag of the FIFOs of CannyPipeline in canny_edge_detection_perf()
+struct CannyPerfLinks;
+
+// counters of each monitor since reset
+static PerfCounters perf_in_total;
+static PerfCounters perf_out_total;
+
+//-- DATAFLOW processes of the monitors: each one keeps its own counters
+//   and writes them to its fields of the perf registers
+static void PerfInMonitor(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_dst,
+                          uint32_t& sof_discarded, uint32_t& short_lines, uint32_t& long_lines, uint32_t& in_stalls,
+                          uint32_t width, uint32_t height) {
+    HlsImProc::AXISInMonitor<MAX_WIDTH, MAX_HEIGHT, 24, 1>(axis_in, axis_dst, perf_in_total, width, height);
+    sof_discarded = perf_in_total.sof_discarded;
+    short_lines   = perf_in_total.short_lines;
+    long_lines    = perf_in_total.long_lines;
+    in_stalls     = perf_in_total.in_stalls;
+}
+
+static void PerfOutMonitor(stream<ImAxis<24> >& axis_src, stream<ImAxis<24> >& axis_out,
+                           uint32_t& frames, uint32_t& out_stalls, uint32_t& edge_pixels,
+                           uint32_t width, uint32_t height) {
+    HlsImProc::AXISOutMonitor<MAX_WIDTH, MAX_HEIGHT, 1>(axis_src, axis_out, perf_out_total, width, height);
+    frames      = perf_out_total.frames;
+    out_stalls  = perf_out_total.out_stalls;
+    edge_pixels = perf_out_total.edge_pixels;
+}
+
+// Top Function
+void canny_edge_detection_perf(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_out,
+                               uint8_t& hist_hthr, uint8_t& hist_lthr,
+                               uint32_t& im_width, uint32_t& im_height, PerfCounters& perf) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=perf bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+    // FIFO directive
+    #pragma HLS STREAM variable=perf_axis_in depth=1
+    #pragma HLS STREAM variable=perf_axis_out depth=1
+
+    const uint32_t PADDING_SIZE = 5;
+    const StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+
+    // the perf registers are only written (read-only on CONTROL_BUS)
+    PerfInMonitor(axis_in, perf_axis_in, perf.sof_discarded, perf.short_lines, perf.long_lines, perf.in_stalls,
+                  im_width, im_height);
+    CannyPipeline::Run<FIFO_DEPTH, CannyPerfLinks>(perf_axis_in, perf_axis_out, args);
+    PerfOutMonitor(perf_axis_out, axis_out, perf.frames, perf.out_stalls, perf.edge_pixels, im_width, im_height);
+}
@@ -0,0 +1,64 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// stages between the AXI4-Streams (the FIFOs between them are declared by Pipeline,
+// one beat of PIXELS_PER_CLOCK pixels per word)
+typedef Pipeline<AXIS2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT, PIXELS_PER_CLOCK>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT, PIXELS_PER_CLOCK>,
+                 SobelStage<MAX_WIDTH, MAX_HEIGHT, PIXELS_PER_CLOCK>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT, PIXELS_PER_CLOCK>,
+                 ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT, PIXELS_PER_CLOCK>,
+                 HystThresholdStage<MAX_WIDTH, MAX_HEIGHT, PIXELS_PER_CLOCK>,
+                 HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT, PIXELS_PER_CLOCK>,
+                 GrayArray2AXISStage<MAX_WIDTH, MAX_HEIGHT, PIXELS_PER_CLOCK> > CannyPpcPipeline;
+
+// tag of the FIFOs of CannyPpcPipeline in canny_edge_detection_ppc()
+struct CannyPpcLinks;
+
+// Top Function
+void canny_edge_detection_ppc(stream<ImAxis<24, PIXELS_PER_CLOCK> >& axis_in,
+                              stream<ImAxis<24, PIXELS_PER_CLOCK> >& axis_out,
+                              uint8_t& hist_hthr, uint8_t& hist_lthr,
+                              uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+
+    // same stages as canny_edge_detection() with PIXELS_PER_CLOCK pixels per clock
+    const uint32_t PADDING_SIZE = 5;
+    const StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+    CannyPpcPipeline::Run<FIFO_DEPTH, CannyPpcLinks>(axis_in, axis_out, args);
+}
@@ -0,0 +1,91 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+#define HALF_WIDTH  (MAX_WIDTH / 2)
+#define HALF_HEIGHT (MAX_HEIGHT / 2)
+
+// stages of canny_edge_detection() with the decimated GaussianBlur output as the input of the half resolution level
+// (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<AXIS2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                 DecimateStage<MAX_WIDTH, MAX_HEIGHT, 0>,
+                 SobelStage<MAX_WIDTH, MAX_HEIGHT>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                 ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GrayArray2AXISStage<MAX_WIDTH, MAX_HEIGHT> > CannyPyramidPipeline;
+
+// same stages after the GaussianBlur on a quarter of the pixels
+typedef Pipeline<SobelStage<HALF_WIDTH, HALF_HEIGHT>,
+                 NonMaxSuppressionStage<HALF_WIDTH, HALF_HEIGHT>,
+                 ZeroPaddingStage<HALF_WIDTH, HALF_HEIGHT>,
+                 HystThresholdStage<HALF_WIDTH, HALF_HEIGHT>,
+                 HystThresholdCompStage<HALF_WIDTH, HALF_HEIGHT>,
+                 GrayArray2AXISStage<HALF_WIDTH, HALF_HEIGHT> > CannyPyramidHalfPipeline;
+
+// tags of the FIFOs of CannyPyramidPipeline/CannyPyramidHalfPipeline in canny_edge_detection_pyramid()
+struct CannyPyramidLinks;
+struct CannyPyramidHalfLinks;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// half resolution image from DecimateStage (side channel 0 of CannyPyramidPipeline) to CannyPyramidHalfPipeline
+static uint8_t pyr_half[HALF_WIDTH * HALF_HEIGHT];
+
+// Top Function
+void canny_edge_detection_pyramid(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_out,
+                                  stream<ImAxis<24> >& axis_out_half,
+                                  uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                  uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE axis port=axis_out_half
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+    // FIFO directive
+    #pragma HLS STREAM variable=pyr_half depth=1 dim=1
+
+    // AXI4-Stream -> GrayScale image -> gaussian bler (the anti-aliasing filter of the half resolution level
+    // as well) -> decimation -> sobel filter -> non-maximum suppression -> zero padding at boundary pixel
+    // -> hysteresis threshold -> comparison operation at neighboring pixels -> AXI4-Stream
+    StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+    CannyPyramidPipeline::Run<FIFO_DEPTH, CannyPyramidLinks>(axis_in, axis_out, args, pyr_half);
+
+    // half resolution: same stages on the decimated image
+    StageArgs half_args = { im_width / 2, im_height / 2, hist_hthr, hist_lthr, PADDING_SIZE };
+    CannyPyramidHalfPipeline::Run<FIFO_DEPTH, CannyPyramidHalfLinks>(pyr_half, axis_out_half, half_args);
+}
@@ -0,0 +1,69 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// stages of canny_edge_detection() on the window of the ROI (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<AXIS2GrayArrayRoiStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                 SobelStage<MAX_WIDTH, MAX_HEIGHT>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                 ZeroPaddingRoiStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GrayArray2AXISRoiStage<MAX_WIDTH, MAX_HEIGHT> > CannyRoiPipeline;
+
+// tag of the FIFOs of CannyRoiPipeline in canny_edge_detection_roi()
+struct CannyRoiLinks;
+
+// Top Function
+void canny_edge_detection_roi(stream<ImAxis<24> >& axis_in, stream<ImAxis<24> >& axis_out,
+                              uint8_t& hist_hthr, uint8_t& hist_lthr,
+                              uint32_t& im_width, uint32_t& im_height,
+                              uint32_t& roi_x, uint32_t& roi_y, uint32_t& roi_width, uint32_t& roi_height) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=roi_x bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=roi_y bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=roi_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=roi_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+
+    // AXIS2GrayArrayRoi reads the whole frame and passes on the window of the ROI (with ROI_HALO/ROI_MARGIN
+    // rows/columns around it), the stages after it run on the window only and GrayArray2AXISRoi outputs the ROI
+    const uint32_t PADDING_SIZE = 5;
+    const StageArgs args = RoiStageArgs(roi_x, roi_y, roi_width, roi_height, im_width, im_height, ROI_HALO, ROI_MARGIN,
+                                        hist_hthr, hist_lthr, PADDING_SIZE);
+    CannyRoiPipeline::Run<FIFO_DEPTH, CannyRoiLinks>(axis_in, axis_out, args);
+}
@@ -0,0 +1,75 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// stages of canny_edge_detection() with the edge pixels output as (x, y, direction)
+// (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<AXIS2GrayArrayStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GaussianBlurStage<MAX_WIDTH, MAX_HEIGHT>,
+                 SobelStage<MAX_WIDTH, MAX_HEIGHT>,
+                 GradTapStage<MAX_WIDTH, MAX_HEIGHT, 0>,
+                 NonMaxSuppressionStage<MAX_WIDTH, MAX_HEIGHT>,
+                 ZeroPaddingStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdStage<MAX_WIDTH, MAX_HEIGHT>,
+                 HystThresholdCompStage<MAX_WIDTH, MAX_HEIGHT>,
+                 EdgeArray2AXISSparseStage<MAX_WIDTH, MAX_HEIGHT, 0> > CannySparsePipeline;
+
+// tag of the FIFOs of CannySparsePipeline in canny_edge_detection_sparse()
+struct CannySparseLinks;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// gradient from GradTapStage to EdgeArray2AXISSparseStage (side channel 0 of CannySparsePipeline)
+static GradPix sparse_grad[MAX_WIDTH * MAX_HEIGHT];
+
+// Top Function
+void canny_edge_detection_sparse(stream<ImAxis<24> >& axis_in, stream<ImAxis<32> >& axis_out,
+                                 uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                 uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE axis port=axis_in
+    #pragma HLS INTERFACE axis port=axis_out
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+    // pipeline directive
+    #pragma HLS DATAFLOW
+    // FIFO directive
+    // the gradient bypasses four stages, so it has to cover their pipeline latency
+    #pragma HLS STREAM variable=sparse_grad depth=SPARSE_GRAD_DEPTH dim=1
+
+    // AXI4-Stream -> GrayScale image -> gaussian bler -> sobel filter (the gradient direction also goes to
+    // the output stage) -> non-maximum suppression -> zero padding at boundary pixel -> hysteresis threshold
+    // -> comparison operation at neighboring pixels -> AXI4-Stream of (x, y, direction) of the edge pixels
+    // and the number of edge pixels
+    StageArgs args = { im_width, im_height, hist_hthr, hist_lthr, PADDING_SIZE };
+    CannySparsePipeline::Run<FIFO_DEPTH, CannySparseLinks>(axis_in, axis_out, args, sparse_grad);
+}
@@ -0,0 +1,87 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2019 Yuya Kudo.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "canny_edge_detection.h"
+
+using namespace hls;
+using namespace hlsimproc;
+
+// padding of ZeroPadding
+static const uint32_t PADDING_SIZE = 5;
+
+// stages of canny_edge_detection() on the window of a stripe (the FIFOs between them are declared by Pipeline)
+typedef Pipeline<Mem2GrayArrayStripeStage<STRIPE_WINDOW, STRIPE_MAX_HEIGHT>,
+                 GaussianBlurStage<STRIPE_WINDOW, STRIPE_MAX_HEIGHT>,
+                 SobelStage<STRIPE_WINDOW, STRIPE_MAX_HEIGHT>,
+                 NonMaxSuppressionStage<STRIPE_WINDOW, STRIPE_MAX_HEIGHT>,
+                 ZeroPaddingRoiStage<STRIPE_WINDOW, STRIPE_MAX_HEIGHT>,
+                 HystThresholdStage<STRIPE_WINDOW, STRIPE_MAX_HEIGHT>,
+                 HystThresholdCompStage<STRIPE_WINDOW, STRIPE_MAX_HEIGHT>,
+                 GrayArray2MemStripeStage<STRIPE_WINDOW, STRIPE_MAX_HEIGHT> > CannyStripePipeline;
+
+// tag of the FIFOs of CannyStripePipeline in canny_edge_detection_stripes()
+struct CannyStripeLinks;
+
+// one stripe (the DATAFLOW region the stripe loop of the top function starts once per stripe)
+static void canny_edge_detection_stripe(const uint32_t* src_frame, uint8_t* dst_stripe, const StageArgs& args) {
+    #pragma HLS INLINE off
+    #pragma HLS DATAFLOW
+    CannyStripePipeline::Run<FIFO_DEPTH, CannyStripeLinks>(src_frame, dst_stripe, args);
+}
+
+// Top Function
+void canny_edge_detection_stripes(const uint32_t* src_mem, uint8_t* dst_mem,
+                                  uint32_t& src_stride, uint32_t& dst_stride,
+                                  uint8_t& hist_hthr, uint8_t& hist_lthr,
+                                  uint32_t& im_width, uint32_t& im_height) {
+    // interface directive
+    #pragma HLS INTERFACE m_axi port=src_mem offset=slave bundle=SRC_BUS max_read_burst_length=256
+    #pragma HLS INTERFACE m_axi port=dst_mem offset=slave bundle=DST_BUS max_write_burst_length=256
+    #pragma HLS INTERFACE s_axilite port=src_mem bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=dst_mem bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=src_stride bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=dst_stride bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_hthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=hist_lthr bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_width bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=im_height bundle=CONTROL_BUS clock=s_axi_aclk
+    #pragma HLS INTERFACE s_axilite port=return bundle=CONTROL_BUS clock=s_axi_aclk
+
+    // registers are latched once per frame
+    const uint32_t frame_width  = (im_width < STRIPE_MAX_WIDTH) ? im_width : STRIPE_MAX_WIDTH;
+    const uint32_t frame_height = (im_height < STRIPE_MAX_HEIGHT) ? im_height : STRIPE_MAX_HEIGHT;
+    const uint8_t hthr = hist_hthr;
+    const uint8_t lthr = hist_lthr;
+    const uint32_t src_line = src_stride;
+    const uint32_t dst_line = dst_stride;
+
+    // each stripe reads ROI_HALO + ROI_MARGIN columns more than it outputs
+    // (the input is read (STRIPE_WIDTH + ROI_HALO + ROI_MARGIN) / STRIPE_WIDTH times)
+    for(uint32_t x = 0; x < frame_width; x += STRIPE_WIDTH) {
+        #pragma HLS LOOP_TRIPCOUNT max=STRIPE_MAX_WIDTH/STRIPE_WIDTH
+        const StageArgs args = StripeStageArgs(x, STRIPE_WIDTH, frame_width, frame_height, ROI_HALO, ROI_MARGIN,
+                                               hthr, lthr, PADDING_SIZE, src_line, dst_line);
+        canny_edge_detection_stripe(src_mem, dst_mem + x, args);
+    }
+}
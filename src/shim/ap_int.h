@@ -0,0 +1,250 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2019 Yuya Kudo.
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SRC_SHIM_AP_INT_H_
+#define SRC_SHIM_AP_INT_H_
+
+// host-only stand-in for the arbitrary precision integers of Vivado HLS
+// (the subset used by HlsImProc)
+//
+// the value is kept in the narrowest of uint8_t/uint16_t/uint32_t/uint64_t that holds
+// W bits (as ap_private of Vivado HLS, so sizeof(ap_uint<10>) == 2), or in 64bit words
+// for W > 64, truncated to W bits and sign extended (ap_int) when it is read. Arithmetic converts to long long
+// (unsigned long long for ap_uint<64> and wider), which is exact for every
+// expression of HlsImProc because the Vivado types widen their results the same way.
+// Words above the first one only take part in assignment, comparison and range().
+
+#include <stdint.h>
+
+#include <type_traits>
+
+template<int W, bool S>
+class ap_int_base;
+
+// bits [hi:lo] of an ap_int_base (hi - lo < 64)
+template<int W, bool S>
+class ap_range_ref {
+    public:
+    ap_range_ref(ap_int_base<W, S>* base, int hi, int lo) : base_(base), hi_(hi), lo_(lo) {}
+
+    ap_range_ref& operator=(unsigned long long value) {
+        base_->set_bits(hi_, lo_, value);
+        return *this;
+    }
+    ap_range_ref& operator=(const ap_range_ref& other) {
+        base_->set_bits(hi_, lo_, other.to_uint64());
+        return *this;
+    }
+    template<int W2, bool S2>
+    ap_range_ref& operator=(const ap_int_base<W2, S2>& value) {
+        base_->set_bits(hi_, lo_, value.to_uint64());
+        return *this;
+    }
+
+    operator unsigned long long() const {
+        return to_uint64();
+    }
+    unsigned long long to_uint64() const {
+        return base_->get_bits(hi_, lo_);
+    }
+    unsigned int to_uint() const {
+        return (unsigned int)to_uint64();
+    }
+    int to_int() const {
+        return (int)to_uint64();
+    }
+    int length() const {
+        return hi_ - lo_ + 1;
+    }
+
+    private:
+    ap_int_base<W, S>* base_;
+    int hi_;
+    int lo_;
+};
+
+template<int W, bool S>
+class ap_int_base {
+    public:
+    static const int WORDS = (W + 63) / 64;
+    // type of each stored word
+    typedef typename std::conditional<(W <= 8), uint8_t,
+            typename std::conditional<(W <= 16), uint16_t,
+            typename std::conditional<(W <= 32), uint32_t, uint64_t>::type>::type>::type word_type;
+    // type every arithmetic expression is evaluated in
+    typedef typename std::conditional<(W < 64) || (S && W == 64), long long, unsigned long long>::type value_type;
+
+    ap_int_base() {
+        for(int i = 0; i < WORDS; i++) {
+            words_[i] = 0;
+        }
+    }
+    template<typename T>
+    ap_int_base(T value, typename std::enable_if<std::is_arithmetic<T>::value>::type* = 0) {
+        set((long long)value, value < T(0));
+    }
+    template<int W2, bool S2>
+    ap_int_base(const ap_int_base<W2, S2>& other) {
+        for(int i = 0; i < WORDS; i++) {
+            store(i, other.word(i));
+        }
+    }
+    template<int W2, bool S2>
+    ap_int_base(const ap_range_ref<W2, S2>& ref) {
+        set((long long)ref.to_uint64(), false);
+    }
+
+    operator value_type() const {
+        return value_type(load(0));
+    }
+
+    //--- compound assignment (single word)
+    template<typename T> ap_int_base& operator+=(const T& x) { return *this = value_type(*this) + x; }
+    template<typename T> ap_int_base& operator-=(const T& x) { return *this = value_type(*this) - x; }
+    template<typename T> ap_int_base& operator*=(const T& x) { return *this = value_type(*this) * x; }
+    template<typename T> ap_int_base& operator/=(const T& x) { return *this = value_type(*this) / x; }
+    template<typename T> ap_int_base& operator&=(const T& x) { return *this = value_type(*this) & x; }
+    template<typename T> ap_int_base& operator|=(const T& x) { return *this = value_type(*this) | x; }
+    template<typename T> ap_int_base& operator^=(const T& x) { return *this = value_type(*this) ^ x; }
+    ap_int_base& operator<<=(int n) { return *this = value_type(*this) << n; }
+    ap_int_base& operator>>=(int n) { return *this = value_type(*this) >> n; }
+    ap_int_base& operator++() { return *this += 1; }
+    ap_int_base& operator--() { return *this -= 1; }
+    ap_int_base operator++(int) { ap_int_base old = *this; *this += 1; return old; }
+    ap_int_base operator--(int) { ap_int_base old = *this; *this -= 1; return old; }
+
+    //--- bit access
+    ap_range_ref<W, S> range(int hi, int lo) {
+        return ap_range_ref<W, S>(this, hi, lo);
+    }
+    const ap_range_ref<W, S> range(int hi, int lo) const {
+        return ap_range_ref<W, S>(const_cast<ap_int_base*>(this), hi, lo);
+    }
+    ap_range_ref<W, S> operator()(int hi, int lo) {
+        return range(hi, lo);
+    }
+    bool operator[](int bit) const {
+        return get_bits(bit, bit) != 0;
+    }
+
+    //--- conversion
+    int to_int() const { return (int)load(0); }
+    unsigned int to_uint() const { return (unsigned int)load(0); }
+    long long to_int64() const { return (long long)load(0); }
+    unsigned long long to_uint64() const { return load(0); }
+    int length() const { return W; }
+
+    //--- comparison of every word (also for W > 64)
+    template<int W2, bool S2>
+    bool operator==(const ap_int_base<W2, S2>& other) const {
+        const int n = (WORDS > ap_int_base<W2, S2>::WORDS) ? WORDS : ap_int_base<W2, S2>::WORDS;
+        for(int i = 0; i < n; i++) {
+            if(word(i) != other.word(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    template<int W2, bool S2>
+    bool operator!=(const ap_int_base<W2, S2>& other) const {
+        return !(*this == other);
+    }
+
+    // word i, extended by the sign (or zero) above the width
+    uint64_t word(int i) const {
+        if(i < WORDS) {
+            return load(i);
+        }
+        return (S && (long long)load(WORDS - 1) < 0) ? ~uint64_t(0) : 0;
+    }
+
+    unsigned long long get_bits(int hi, int lo) const {
+        const int len = hi - lo + 1;
+        uint64_t value = load(lo / 64) >> (lo % 64);
+        if(lo % 64 != 0 && lo / 64 + 1 < WORDS) {
+            value |= load(lo / 64 + 1) << (64 - lo % 64);
+        }
+        return (len < 64) ? (value & ((uint64_t(1) << len) - 1)) : value;
+    }
+
+    void set_bits(int hi, int lo, unsigned long long value) {
+        const int len = hi - lo + 1;
+        const uint64_t mask = (len < 64) ? ((uint64_t(1) << len) - 1) : ~uint64_t(0);
+        value &= mask;
+        store(lo / 64, (load(lo / 64) & ~(mask << (lo % 64))) | (value << (lo % 64)));
+        if(lo % 64 != 0 && lo / 64 + 1 < WORDS && lo % 64 + len > 64) {
+            const int shift = 64 - lo % 64;
+            store(lo / 64 + 1, (load(lo / 64 + 1) & ~(mask >> shift)) | (value >> shift));
+        }
+    }
+
+    private:
+    void set(long long value, bool negative) {
+        store(0, uint64_t(value));
+        for(int i = 1; i < WORDS; i++) {
+            store(i, negative ? ~uint64_t(0) : 0);
+        }
+    }
+
+    // bits of W in the top word, and their mask
+    static const int TOP = W - 64*(WORDS - 1);
+    static const uint64_t TOP_MASK = (TOP < 64) ? (uint64_t(1) << (TOP % 64)) - 1 : ~uint64_t(0);
+
+    // word i, the top word sign extended (ap_int) or zero extended (ap_uint) from W bits
+    uint64_t load(int i) const {
+        uint64_t w = words_[i];
+        if(i == WORDS - 1 && TOP < 64 && S && ((w >> (TOP - 1)) & 1)) {
+            w |= ~TOP_MASK;
+        }
+        return w;
+    }
+
+    // store word i, the top word truncated to W bits
+    void store(int i, uint64_t w) {
+        if(i == WORDS - 1 && TOP < 64) {
+            w &= TOP_MASK;
+        }
+        words_[i] = word_type(w);
+    }
+
+    word_type words_[WORDS];
+};
+
+template<int W>
+class ap_uint : public ap_int_base<W, false> {
+    public:
+    ap_uint() {}
+    template<typename T>
+    ap_uint(const T& value) : ap_int_base<W, false>(value) {}
+};
+
+template<int W>
+class ap_int : public ap_int_base<W, true> {
+    public:
+    ap_int() {}
+    template<typename T>
+    ap_int(const T& value) : ap_int_base<W, true>(value) {}
+};
+
+#endif /* SRC_SHIM_AP_INT_H_ */
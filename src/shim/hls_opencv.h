@@ -0,0 +1,133 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2019 Yuya Kudo.
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SRC_SHIM_HLS_OPENCV_H_
+#define SRC_SHIM_HLS_OPENCV_H_
+
+// host-only stand-in for hls_opencv.h of Vivado HLS: 8bit 3 channel (BGR) cv::Mat,
+// PNG file I/O by libpng and the conversions from/to AXI4-Stream video
+// (pixels in raster order, user at start of frame, last at end of line)
+
+#include <png.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ap_axi_sdata.h"
+#include "hls_stream.h"
+
+namespace cv {
+    // 8bit BGR image (copies share the pixels as in OpenCV)
+    class Mat {
+        public:
+        Mat() : rows(0), cols(0) {}
+        Mat(int rows_, int cols_) : rows(rows_), cols(cols_), buf_(new std::vector<uint8_t>(size_t(rows_) * cols_ * 3)) {}
+
+        bool empty() const {
+            return !buf_ || buf_->empty();
+        }
+        int channels() const {
+            return 3;
+        }
+        uint8_t* ptr(int y) {
+            return buf_->data() + size_t(y) * cols * 3;
+        }
+        const uint8_t* ptr(int y) const {
+            return buf_->data() + size_t(y) * cols * 3;
+        }
+
+        int rows;
+        int cols;
+
+        private:
+        std::shared_ptr<std::vector<uint8_t> > buf_;
+    };
+
+    // read a PNG file as 8bit BGR (empty Mat on error)
+    inline Mat imread(const std::string& filename) {
+        png_image image = png_image();
+        image.version = PNG_IMAGE_VERSION;
+        if(!png_image_begin_read_from_file(&image, filename.c_str())) {
+            return Mat();
+        }
+        image.format = PNG_FORMAT_BGR;
+        Mat mat(image.height, image.width);
+        if(!png_image_finish_read(&image, NULL, mat.ptr(0), 0, NULL)) {
+            png_image_free(&image);
+            return Mat();
+        }
+        return mat;
+    }
+
+    // write 8bit BGR as a PNG file
+    inline bool imwrite(const std::string& filename, const Mat& mat) {
+        png_image image = png_image();
+        image.version = PNG_IMAGE_VERSION;
+        image.width   = mat.cols;
+        image.height  = mat.rows;
+        image.format  = PNG_FORMAT_BGR;
+        return png_image_write_to_file(&image, filename.c_str(), 0, mat.ptr(0), 0, NULL) != 0;
+    }
+}
+
+// channel c of a pixel in data[8*c+7 : 8*c]
+template<int W, int U, int TI, int TD>
+void cvMat2AXIvideo(const cv::Mat& mat, hls::stream<ap_axiu<W, U, TI, TD> >& axis_dst) {
+    ap_axiu<W, U, TI, TD> axis_writer;
+    for(int yi = 0; yi < mat.rows; yi++) {
+        const uint8_t* row = mat.ptr(yi);
+        for(int xi = 0; xi < mat.cols; xi++) {
+            axis_writer.data = uint32_t(row[3*xi]) | uint32_t(row[3*xi + 1]) << 8 | uint32_t(row[3*xi + 2]) << 16;
+            axis_writer.user = (xi == 0 && yi == 0);
+            axis_writer.last = (xi == mat.cols - 1);
+            axis_dst << axis_writer;
+        }
+    }
+}
+
+// waits for the start of frame, as the Vivado function does
+template<int W, int U, int TI, int TD>
+void AXIvideo2cvMat(hls::stream<ap_axiu<W, U, TI, TD> >& axis_src, cv::Mat& mat) {
+    ap_axiu<W, U, TI, TD> axis_reader;
+    do {
+        axis_src >> axis_reader;
+    } while(!axis_reader.user.to_int());
+
+    for(int yi = 0; yi < mat.rows; yi++) {
+        uint8_t* row = mat.ptr(yi);
+        for(int xi = 0; xi < mat.cols; xi++) {
+            if(xi != 0 || yi != 0) {
+                axis_src >> axis_reader;
+            }
+            row[3*xi]     = axis_reader.data.range(7, 0).to_uint();
+            row[3*xi + 1] = axis_reader.data.range(15, 8).to_uint();
+            row[3*xi + 2] = axis_reader.data.range(23, 16).to_uint();
+        }
+    }
+}
+
+#endif /* SRC_SHIM_HLS_OPENCV_H_ */
@@ -0,0 +1,97 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2019 Yuya Kudo.
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SRC_SHIM_HLS_STREAM_H_
+#define SRC_SHIM_HLS_STREAM_H_
+
+// host-only stand-in for hls::stream of Vivado HLS (unbounded FIFO)
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <deque>
+#include <string>
+
+namespace hls {
+    template<typename T>
+    class stream {
+        public:
+        stream() {}
+        explicit stream(const char* name) : name_(name) {}
+
+        // reading an empty stream is an error in C simulation
+        T read() {
+            if(fifo_.empty()) {
+                fprintf(stderr, "hls::stream %s is read while empty\n", name_.c_str());
+                abort();
+            }
+            T value = fifo_.front();
+            fifo_.pop_front();
+            return value;
+        }
+        void read(T& value) {
+            value = read();
+        }
+        bool read_nb(T& value) {
+            if(fifo_.empty()) {
+                return false;
+            }
+            value = read();
+            return true;
+        }
+        void write(const T& value) {
+            fifo_.push_back(value);
+        }
+        bool write_nb(const T& value) {
+            write(value);
+            return true;
+        }
+
+        void operator>>(T& value) {
+            value = read();
+        }
+        void operator<<(const T& value) {
+            write(value);
+        }
+
+        bool empty() const {
+            return fifo_.empty();
+        }
+        bool full() const {
+            return false;
+        }
+        size_t size() const {
+            return fifo_.size();
+        }
+
+        private:
+        stream(const stream&);
+        stream& operator=(const stream&);
+
+        std::deque<T> fifo_;
+        std::string name_;
+    };
+}
+
+#endif /* SRC_SHIM_HLS_STREAM_H_ */
@@ -22,12 +22,588 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
 #include <hls_opencv.h>
 #include "../src/canny_edge_detection.h"
+#include "../src/HostCannyEngine.hpp"
+#include "../src/HostCannyKernels.hpp"
+
+// pack a frame of D bit pixels into beats of PPC pixels
+// (the width x height pixels at the top left of the frame when smaller than it)
+template<int PPC, int D = 24>
+void PackBeats(const std::vector<uint32_t>& frame, hls::stream<hlsimproc::ImAxis<D, PPC> >& axis_dst,
+               int width = MAX_WIDTH, int height = MAX_HEIGHT) {
+    hlsimproc::ImAxis<D, PPC> axis_writer;
+    for(int yi = 0; yi < height; yi++) {
+        for(int xi = 0; xi < width; xi += PPC) {
+            for(int p = 0; p < PPC; p++) {
+                axis_writer.data.range(D*p + D - 1, D*p) = frame[xi + p + yi*MAX_WIDTH];
+            }
+            axis_writer.user = (xi == 0 && yi == 0);
+            axis_writer.last = (xi == width - PPC);
+            axis_dst << axis_writer;
+        }
+    }
+}
+
+// line yi of a frame of the time-multiplexed stream dest
+void PackStreamLine(const std::vector<uint32_t>& frame, int yi, int dest,
+                    hls::stream<hlsimproc::ImAxis<24, 1, STREAM_DEST_W> >& axis_dst) {
+    hlsimproc::ImAxis<24, 1, STREAM_DEST_W> axis_writer;
+    for(int xi = 0; xi < MAX_WIDTH; xi++) {
+        axis_writer.data = frame[xi + yi*MAX_WIDTH];
+        axis_writer.user = (xi == 0 && yi == 0);
+        axis_writer.last = (xi == MAX_WIDTH - 1);
+        axis_writer.dest = dest;
+        axis_dst << axis_writer;
+    }
+}
+
+// sort the output lines of the time-multiplexed streams by TDEST
+// (false when a line has a wrong user/last signal)
+bool UnpackStreams(hls::stream<hlsimproc::ImAxis<24, 1, STREAM_DEST_W> >& axis_src,
+                   std::vector<uint8_t> edge[MAX_STREAMS]) {
+    int line[MAX_STREAMS] = {0};
+    hlsimproc::ImAxis<24, 1, STREAM_DEST_W> axis_reader;
+    for(int i = 0; i < MAX_STREAMS * MAX_HEIGHT; i++) {
+        int dest = 0;
+        for(int xi = 0; xi < MAX_WIDTH; xi++) {
+            axis_src >> axis_reader;
+            if(xi == 0) {
+                dest = axis_reader.dest.to_int();
+            }
+            const int yi = line[dest];
+            if(yi >= MAX_HEIGHT || axis_reader.dest != dest ||
+               axis_reader.user != (xi == 0 && yi == 0) || axis_reader.last != (xi == MAX_WIDTH - 1)) {
+                return false;
+            }
+            edge[dest][xi + yi*MAX_WIDTH] = axis_reader.data & 0xff;
+        }
+        line[dest]++;
+    }
+    return true;
+}
+
+// frame with num_discard beats before the start of frame, line short_line num_short beats short
+// and line long_line num_long beats long (the line is closed by the last signal of its last beat)
+void PackMalformed(const std::vector<uint32_t>& frame, int num_discard, int short_line, int num_short,
+                   int long_line, int num_long, hls::stream<hlsimproc::ImAxis<24> >& axis_dst) {
+    hlsimproc::ImAxis<24> axis_writer;
+    for(int i = 0; i < num_discard; i++) {
+        axis_writer.data = frame[i];
+        axis_writer.user = 0;
+        axis_writer.last = (i == 0);
+        axis_dst << axis_writer;
+    }
+    for(int yi = 0; yi < MAX_HEIGHT; yi++) {
+        const int line_beats = MAX_WIDTH - ((yi == short_line) ? num_short : 0) + ((yi == long_line) ? num_long : 0);
+        for(int xi = 0; xi < line_beats; xi++) {
+            axis_writer.data = frame[std::min(xi, MAX_WIDTH - 1) + yi*MAX_WIDTH];
+            axis_writer.user = (xi == 0 && yi == 0);
+            axis_writer.last = (xi == line_beats - 1);
+            axis_dst << axis_writer;
+        }
+    }
+}
+
+// AXISInMonitor -> AXISOutMonitor on threads of the dataflow model between a source that writes a beat
+// of the frame every src_period cycles and a sink that reads one every sink_period cycles
+// (the counters of both monitors are stored to perf, the output pixels to out)
+void MonitorDataflow(const std::vector<uint32_t>& frame, uint64_t src_period, uint64_t sink_period,
+                     hlsimproc::PerfCounters& perf, std::vector<uint32_t>& out) {
+    typedef hlsimproc::SpscFifo<hlsimproc::ImAxis<24>, FIFO_DEPTH> Link;
+    Link src, link, dst;
+    hlsimproc::PerfCounters perf_in = perf;
+    hlsimproc::PerfCounters perf_out = perf;
+
+    hlsimproc::DataflowRegion region;
+    region.Spawn([&] {
+        hlsimproc::ImAxis<24> axis_writer;
+        for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+            axis_writer.data = frame[i];
+            axis_writer.user = (i == 0);
+            axis_writer.last = (i % MAX_WIDTH == MAX_WIDTH - 1);
+            hlsimproc::ProcessCycle() += src_period;
+            src.write(axis_writer);
+        }
+    });
+    region.Spawn([&] {
+        hlsimproc::HlsImProc::AXISInMonitor<MAX_WIDTH, MAX_HEIGHT, 24, 1>(src, link, perf_in);
+    });
+    region.Spawn([&] {
+        hlsimproc::HlsImProc::AXISOutMonitor<MAX_WIDTH, MAX_HEIGHT, 1>(link, dst, perf_out);
+    });
+    region.Spawn([&] {
+        for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+            hlsimproc::ProcessCycle() += sink_period;
+            out[i] = dst.read().data.to_uint();
+        }
+    });
+    region.Join();
+
+    perf.sof_discarded = perf_in.sof_discarded;
+    perf.short_lines   = perf_in.short_lines;
+    perf.long_lines    = perf_in.long_lines;
+    perf.in_stalls     = perf_in.in_stalls;
+    perf.frames        = perf_out.frames;
+    perf.out_stalls    = perf_out.out_stalls;
+    perf.edge_pixels   = perf_out.edge_pixels;
+}
+
+// unpack beats of PPC pixels into one 8bit value per pixel
+template<int PPC>
+void UnpackBeats(hls::stream<hlsimproc::ImAxis<24, PPC> >& axis_src, std::vector<uint8_t>& edge) {
+    hlsimproc::ImAxis<24, PPC> axis_reader;
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i += PPC) {
+        axis_src >> axis_reader;
+        for(int p = 0; p < PPC; p++) {
+            edge[i + p] = axis_reader.data.range(24*p + 7, 24*p);
+        }
+    }
+}
+
+// canny edge detection of a grayscale frame (the stages after AXIS2GrayArray)
+void CannyStagesGray(const std::vector<uint8_t>& gray, std::vector<uint8_t>& edge, uint8_t hthr, uint8_t lthr) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_PIXELS = MAX_WIDTH * MAX_HEIGHT;
+    std::vector<uint8_t> gauss(NUM_PIXELS), nms(NUM_PIXELS), padded(NUM_PIXELS), hyst(NUM_PIXELS);
+    std::vector<hlsimproc::GradPix> grad(NUM_PIXELS);
+
+    HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT>(gray.data(), gauss.data());
+    HlsImProc::Sobel<MAX_WIDTH, MAX_HEIGHT>(gauss.data(), grad.data());
+    HlsImProc::NonMaxSuppression<MAX_WIDTH, MAX_HEIGHT>(grad.data(), nms.data());
+    HlsImProc::ZeroPadding<MAX_WIDTH, MAX_HEIGHT>(nms.data(), padded.data(), 5);
+    HlsImProc::HystThreshold<MAX_WIDTH, MAX_HEIGHT>(padded.data(), hyst.data(), hthr, lthr);
+    HlsImProc::HystThresholdComp<MAX_WIDTH, MAX_HEIGHT>(hyst.data(), edge.data());
+}
+
+// GaussianBlur<KSIZE, SIGMA_X100> as the 2D convolution of GaussKernel in raster order
+// (pixels before the frame are 0; the window of the first columns wraps to the previous line
+// as the window buffer of the stage does), compared with the separable stage at PPC pixels per clock
+template<int KSIZE, int SIGMA_X100, int PPC>
+bool GaussianKernelCheck(const std::vector<uint8_t>& gray) {
+    typedef hlsimproc::GaussKernel<KSIZE, SIGMA_X100> Kernel;
+    const int NUM_BEATS = MAX_WIDTH * MAX_HEIGHT / PPC;
+    std::vector<hlsimproc::PixBeat<uint8_t, PPC> > gray_beat(NUM_BEATS), gauss_beat(NUM_BEATS);
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        gray_beat[i / PPC].pix[i % PPC] = gray[i];
+    }
+    hlsimproc::HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT, PPC, KSIZE, SIGMA_X100>(gray_beat.data(), gauss_beat.data());
+
+    printf("gaussian kernel %dx%d sigma %.2f :", KSIZE, KSIZE, SIGMA_X100 / 100.0);
+    for(int k = 0; k < KSIZE; k++) {
+        printf(" %d", Kernel::COEF[k]);
+    }
+    printf(" (/ %d)\n", 1 << Kernel::SHIFT);
+
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        int pix_gauss = 0;
+        for(int yw = 0; yw < KSIZE; yw++) {
+            for(int xw = 0; xw < KSIZE; xw++) {
+                const int pos = i - (KSIZE - 1 - yw)*MAX_WIDTH - (KSIZE - 1 - xw);
+                if(pos >= 0) {
+                    pix_gauss += gray[pos] * Kernel::COEF[yw] * Kernel::COEF[xw];
+                }
+            }
+        }
+        if(gauss_beat[i / PPC].pix[i % PPC] != (pix_gauss >> (2 * Kernel::SHIFT))) {
+            printf("gaussian kernel %dx%d sigma %.2f mismatch at (%d, %d)\n",
+                   KSIZE, KSIZE, SIGMA_X100 / 100.0, i % MAX_WIDTH, i / MAX_WIDTH);
+            return false;
+        }
+    }
+    return true;
+}
+
+// luma of a raw Bayer RGGB frame as defined by PIX_BAYER_G/PIX_BAYER_BIN
+// (2x2 window ending at each pixel, the raw value on the first line/column)
+void BayerLumaRef(const std::vector<uint32_t>& raw, bool green, std::vector<uint8_t>& luma) {
+    for(int yi = 0; yi < MAX_HEIGHT; yi++) {
+        for(int xi = 0; xi < MAX_WIDTH; xi++) {
+            const int pix = raw[xi + yi*MAX_WIDTH];
+            if(xi == 0 || yi == 0) {
+                luma[xi + yi*MAX_WIDTH] = pix;
+                continue;
+            }
+            int r = 0, g = 0, b = 0;
+            for(int yw = yi - 1; yw <= yi; yw++) {
+                for(int xw = xi - 1; xw <= xi; xw++) {
+                    const int v = raw[xw + yw*MAX_WIDTH];
+                    if(xw % 2 == 0 && yw % 2 == 0) {
+                        r = v;
+                    }
+                    else if(xw % 2 == 1 && yw % 2 == 1) {
+                        b = v;
+                    }
+                    else {
+                        g += v;
+                    }
+                }
+            }
+            const bool pix_is_g = (xi % 2) != (yi % 2);
+            if(green) {
+                luma[xi + yi*MAX_WIDTH] = pix_is_g ? pix : g / 2;
+            }
+            else {
+                luma[xi + yi*MAX_WIDTH] = (77*r + 75*g + 29*b + 128) >> 8;
+            }
+        }
+    }
+}
+
+// canny edge detection with PPC pixels per clock (same stages as canny_edge_detection_ppc())
+template<int PPC>
+void CannyStagesPpc(const std::vector<uint32_t>& frame, std::vector<uint8_t>& edge, uint8_t hthr, uint8_t lthr) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_BEATS = MAX_WIDTH * MAX_HEIGHT / PPC;
+    std::vector<hlsimproc::PixBeat<uint8_t, PPC> > gray(NUM_BEATS), gauss(NUM_BEATS), nms(NUM_BEATS);
+    std::vector<hlsimproc::PixBeat<uint8_t, PPC> > padded(NUM_BEATS), hyst(NUM_BEATS), comp(NUM_BEATS);
+    std::vector<hlsimproc::PixBeat<hlsimproc::GradPix, PPC> > grad(NUM_BEATS);
+    hls::stream<hlsimproc::ImAxis<24, PPC> > axis_in, axis_out;
+
+    PackBeats<PPC>(frame, axis_in);
+    HlsImProc::AXIS2GrayArray<MAX_WIDTH, MAX_HEIGHT>(axis_in, gray.data());
+    HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT, PPC>(gray.data(), gauss.data());
+    HlsImProc::Sobel<MAX_WIDTH, MAX_HEIGHT, PPC>(gauss.data(), grad.data());
+    HlsImProc::NonMaxSuppression<MAX_WIDTH, MAX_HEIGHT, PPC>(grad.data(), nms.data());
+    HlsImProc::ZeroPadding<MAX_WIDTH, MAX_HEIGHT, PPC>(nms.data(), padded.data(), 5);
+    HlsImProc::HystThreshold<MAX_WIDTH, MAX_HEIGHT, PPC>(padded.data(), hyst.data(), hthr, lthr);
+    HlsImProc::HystThresholdComp<MAX_WIDTH, MAX_HEIGHT, PPC>(hyst.data(), comp.data());
+    HlsImProc::GrayArray2AXIS<MAX_WIDTH, MAX_HEIGHT>(comp.data(), axis_out);
+    UnpackBeats<PPC>(axis_out, edge);
+}
+
+// canny edge detection with the gradient magnitude of Sobel computed by MAG
+template<hlsimproc::MagMode MAG>
+void CannyStagesMag(const std::vector<uint32_t>& frame, std::vector<uint8_t>& edge, uint8_t hthr, uint8_t lthr) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_PIXELS = MAX_WIDTH * MAX_HEIGHT;
+    std::vector<uint8_t> gray(NUM_PIXELS), gauss(NUM_PIXELS), nms(NUM_PIXELS), padded(NUM_PIXELS), hyst(NUM_PIXELS);
+    std::vector<hlsimproc::GradPix> grad(NUM_PIXELS);
+    hls::stream<hlsimproc::ImAxis<24> > axis_in;
+
+    PackBeats<1>(frame, axis_in);
+    HlsImProc::AXIS2GrayArray<MAX_WIDTH, MAX_HEIGHT>(axis_in, gray.data());
+    HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT>(gray.data(), gauss.data());
+    HlsImProc::Sobel<MAX_WIDTH, MAX_HEIGHT, 1, MAG>(gauss.data(), grad.data());
+    HlsImProc::NonMaxSuppression<MAX_WIDTH, MAX_HEIGHT>(grad.data(), nms.data());
+    HlsImProc::ZeroPadding<MAX_WIDTH, MAX_HEIGHT>(nms.data(), padded.data(), 5);
+    HlsImProc::HystThreshold<MAX_WIDTH, MAX_HEIGHT>(padded.data(), hyst.data(), hthr, lthr);
+    HlsImProc::HystThresholdComp<MAX_WIDTH, MAX_HEIGHT>(hyst.data(), edge.data());
+}
+
+// canny edge detection of a frame in pixel format FMT (luma is the output of the input stage)
+template<hlsimproc::PixFormat FMT, int PPC>
+void CannyStagesFormat(const std::vector<uint32_t>& frame, std::vector<uint8_t>& luma, std::vector<uint8_t>& edge,
+                       uint8_t hthr, uint8_t lthr) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_BEATS = MAX_WIDTH * MAX_HEIGHT / PPC;
+    std::vector<hlsimproc::PixBeat<uint8_t, PPC> > gray(NUM_BEATS);
+    hls::stream<hlsimproc::ImAxis<hlsimproc::PixFormatBits<FMT>::value, PPC> > axis_in;
+
+    PackBeats<PPC, hlsimproc::PixFormatBits<FMT>::value>(frame, axis_in);
+    HlsImProc::AXIS2LumaArray<MAX_WIDTH, MAX_HEIGHT, FMT>(axis_in, gray.data());
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        luma[i] = gray[i / PPC].pix[i % PPC];
+    }
+    CannyStagesGray(luma, edge, hthr, lthr);
+}
+
+// Sobel output and HystThreshold output of canny edge detection (to check the packed/sparse outputs)
+void CannyStagesGrad(const std::vector<uint32_t>& frame, std::vector<hlsimproc::GradPix>& grad,
+                     std::vector<uint8_t>& hyst, uint8_t hthr, uint8_t lthr) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_PIXELS = MAX_WIDTH * MAX_HEIGHT;
+    std::vector<uint8_t> gray(NUM_PIXELS), gauss(NUM_PIXELS), nms(NUM_PIXELS), padded(NUM_PIXELS);
+    hls::stream<hlsimproc::ImAxis<24> > axis_in;
+
+    PackBeats<1>(frame, axis_in);
+    HlsImProc::AXIS2GrayArray<MAX_WIDTH, MAX_HEIGHT>(axis_in, gray.data());
+    HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT>(gray.data(), gauss.data());
+    HlsImProc::Sobel<MAX_WIDTH, MAX_HEIGHT>(gauss.data(), grad.data());
+    HlsImProc::NonMaxSuppression<MAX_WIDTH, MAX_HEIGHT>(grad.data(), nms.data());
+    HlsImProc::ZeroPadding<MAX_WIDTH, MAX_HEIGHT>(nms.data(), padded.data(), 5);
+    HlsImProc::HystThreshold<MAX_WIDTH, MAX_HEIGHT>(padded.data(), hyst.data(), hthr, lthr);
+}
+
+// edge map of the half resolution level of canny_edge_detection_pyramid(): the GaussianBlur output
+// subsampled at even columns of even lines, and the stages after GaussianBlur at half resolution
+void CannyHalfRef(const std::vector<uint32_t>& frame, std::vector<uint8_t>& edge_half, uint8_t hthr, uint8_t lthr) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int HALF_W = MAX_WIDTH / 2;
+    const int HALF_H = MAX_HEIGHT / 2;
+    std::vector<uint8_t> gray(MAX_WIDTH * MAX_HEIGHT), gauss(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> half(HALF_W * HALF_H), nms(HALF_W * HALF_H), padded(HALF_W * HALF_H), hyst(HALF_W * HALF_H);
+    std::vector<hlsimproc::GradPix> grad(HALF_W * HALF_H);
+    hls::stream<hlsimproc::ImAxis<24> > axis_in;
+
+    PackBeats<1>(frame, axis_in);
+    HlsImProc::AXIS2GrayArray<MAX_WIDTH, MAX_HEIGHT>(axis_in, gray.data());
+    HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT>(gray.data(), gauss.data());
+    for(int yi = 0; yi < HALF_H; yi++) {
+        for(int xi = 0; xi < HALF_W; xi++) {
+            half[xi + yi*HALF_W] = gauss[2*xi + 2*yi*MAX_WIDTH];
+        }
+    }
+    HlsImProc::Sobel<HALF_W, HALF_H>(half.data(), grad.data());
+    HlsImProc::NonMaxSuppression<HALF_W, HALF_H>(grad.data(), nms.data());
+    HlsImProc::ZeroPadding<HALF_W, HALF_H>(nms.data(), padded.data(), 5);
+    HlsImProc::HystThreshold<HALF_W, HALF_H>(padded.data(), hyst.data(), hthr, lthr);
+    HlsImProc::HystThresholdComp<HALF_W, HALF_H>(hyst.data(), edge_half.data());
+}
+
+// signed Sobel gradient of canny_edge_detection_grad() for each pixel of the edge map: the 3x3 kernels on the
+// GaussianBlur output ending 2 lines and 2 pixels before the window of the edge pixel (raster order,
+// 0 before the frame) and 0 where Sobel masks the boundary of the frame
+void GradXYRef(const std::vector<uint32_t>& frame, std::vector<int>& gx, std::vector<int>& gy) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_PIXELS = MAX_WIDTH * MAX_HEIGHT;
+    std::vector<uint8_t> gray(NUM_PIXELS), gauss(NUM_PIXELS);
+    hls::stream<hlsimproc::ImAxis<24> > axis_in;
+
+    PackBeats<1>(frame, axis_in);
+    HlsImProc::AXIS2GrayArray<MAX_WIDTH, MAX_HEIGHT>(axis_in, gray.data());
+    HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT>(gray.data(), gauss.data());
+    for(int i = 0; i < NUM_PIXELS; i++) {
+        // Sobel output at (sx, sy) (window of the pixels (sx - 2 .. sx, sy - 2 .. sy))
+        const int s = i - 2*MAX_WIDTH - 2;
+        const int sx = (s < 0) ? 0 : s % MAX_WIDTH;
+        const int sy = (s < 0) ? 0 : s / MAX_WIDTH;
+        gx[i] = 0;
+        gy[i] = 0;
+        if(3 < sx && sx < MAX_WIDTH - 3 && 3 < sy && sy < MAX_HEIGHT - 3) {
+            int w[3][3];
+            for(int yw = 0; yw < 3; yw++) {
+                for(int xw = 0; xw < 3; xw++) {
+                    w[yw][xw] = gauss[(sx - 2 + xw) + (sy - 2 + yw)*MAX_WIDTH];
+                }
+            }
+            gx[i] = (w[0][0] + 2*w[1][0] + w[2][0]) - (w[0][2] + 2*w[1][2] + w[2][2]);
+            gy[i] = (w[0][0] + 2*w[0][1] + w[0][2]) - (w[2][0] + 2*w[2][1] + w[2][2]);
+        }
+    }
+}
+
+// unpack beats of BEAT_W / BPP pixels into one code per pixel
+// (false when a beat has a wrong user/last signal)
+template<int BPP, int BEAT_W>
+bool UnpackPacked(hls::stream<hlsimproc::ImAxis<BEAT_W> >& axis_src, std::vector<uint8_t>& code) {
+    const int PIX_PER_BEAT = BEAT_W / BPP;
+    const int LINE_BEATS = (MAX_WIDTH + PIX_PER_BEAT - 1) / PIX_PER_BEAT;
+    hlsimproc::ImAxis<BEAT_W> axis_reader;
+    for(int yi = 0; yi < MAX_HEIGHT; yi++) {
+        for(int xb = 0; xb < LINE_BEATS; xb++) {
+            axis_src >> axis_reader;
+            if(axis_reader.user != (xb == 0 && yi == 0) || axis_reader.last != (xb == LINE_BEATS - 1)) {
+                return false;
+            }
+            for(int p = 0; p < PIX_PER_BEAT && xb*PIX_PER_BEAT + p < MAX_WIDTH; p++) {
+                code[xb*PIX_PER_BEAT + p + yi*MAX_WIDTH] = axis_reader.data.range(BPP*p + BPP - 1, BPP*p);
+            }
+        }
+    }
+    return axis_src.empty();
+}
+
+// thresholds of canny_edge_detection_adaptive() derived from one frame of width x height pixels
+// (percentile of the non-zero magnitudes after zero padding)
+void AdaptiveThresholdsRef(const std::vector<uint32_t>& frame, uint8_t hist_pct, uint8_t hist_ratio,
+                           uint8_t& hthr, uint8_t& lthr, uint32_t width = MAX_WIDTH, uint32_t height = MAX_HEIGHT) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_PIXELS = MAX_WIDTH * MAX_HEIGHT;
+    std::vector<uint8_t> gray(NUM_PIXELS), gauss(NUM_PIXELS), nms(NUM_PIXELS), padded(NUM_PIXELS);
+    std::vector<hlsimproc::GradPix> grad(NUM_PIXELS);
+    hls::stream<hlsimproc::ImAxis<24> > axis_in;
+
+    PackBeats<1>(frame, axis_in, width, height);
+    HlsImProc::AXIS2GrayArray<MAX_WIDTH, MAX_HEIGHT>(axis_in, gray.data(), width, height);
+    HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT>(gray.data(), gauss.data(), width, height);
+    HlsImProc::Sobel<MAX_WIDTH, MAX_HEIGHT>(gauss.data(), grad.data(), width, height);
+    HlsImProc::NonMaxSuppression<MAX_WIDTH, MAX_HEIGHT>(grad.data(), nms.data(), width, height);
+    HlsImProc::ZeroPadding<MAX_WIDTH, MAX_HEIGHT>(nms.data(), padded.data(), 5, width, height);
+
+    std::vector<uint32_t> hist(256, 0);
+    uint32_t count = 0;
+    for(int i = 0; i < NUM_PIXELS; i++) {
+        if(padded[i] != 0) {
+            hist[padded[i]]++;
+            count++;
+        }
+    }
+    const uint32_t target = (uint64_t(count) * hist_pct) >> 8;
+    uint32_t cum = 0;
+    for(int bin = 1; bin < 256; bin++) {
+        cum += hist[bin];
+        if(target <= cum) {
+            hthr = bin;
+            lthr = (bin * hist_ratio) >> 8;
+            return;
+        }
+    }
+}
+
+// full hysteresis reference (flood fill from the strong pixels through the weak ones)
+void CannyFullHystRef(const std::vector<uint32_t>& frame, std::vector<uint8_t>& edge, uint8_t hthr, uint8_t lthr) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_PIXELS = MAX_WIDTH * MAX_HEIGHT;
+    std::vector<uint8_t> gray(NUM_PIXELS), gauss(NUM_PIXELS), nms(NUM_PIXELS), padded(NUM_PIXELS), hyst(NUM_PIXELS);
+    std::vector<hlsimproc::GradPix> grad(NUM_PIXELS);
+    hls::stream<hlsimproc::ImAxis<24> > axis_in;
+
+    PackBeats<1>(frame, axis_in);
+    HlsImProc::AXIS2GrayArray<MAX_WIDTH, MAX_HEIGHT>(axis_in, gray.data());
+    HlsImProc::GaussianBlur<MAX_WIDTH, MAX_HEIGHT>(gray.data(), gauss.data());
+    HlsImProc::Sobel<MAX_WIDTH, MAX_HEIGHT>(gauss.data(), grad.data());
+    HlsImProc::NonMaxSuppression<MAX_WIDTH, MAX_HEIGHT>(grad.data(), nms.data());
+    HlsImProc::ZeroPadding<MAX_WIDTH, MAX_HEIGHT>(nms.data(), padded.data(), 5);
+    HlsImProc::HystThreshold<MAX_WIDTH, MAX_HEIGHT>(padded.data(), hyst.data(), hthr, lthr);
+
+    std::deque<int> queue;
+    for(int i = 0; i < NUM_PIXELS; i++) {
+        edge[i] = 0;
+        if(hyst[i] == 0xFF) {
+            edge[i] = 0xFF;
+            queue.push_back(i);
+        }
+    }
+    while(!queue.empty()) {
+        const int xi = queue.front() % MAX_WIDTH;
+        const int yi = queue.front() / MAX_WIDTH;
+        queue.pop_front();
+        for(int dy = -1; dy <= 1; dy++) {
+            for(int dx = -1; dx <= 1; dx++) {
+                const int xn = xi + dx;
+                const int yn = yi + dy;
+                if(0 <= xn && xn < MAX_WIDTH && 0 <= yn && yn < MAX_HEIGHT &&
+                   hyst[xn + yn*MAX_WIDTH] != 0 && edge[xn + yn*MAX_WIDTH] == 0) {
+                    edge[xn + yn*MAX_WIDTH] = 0xFF;
+                    queue.push_back(xn + yn*MAX_WIDTH);
+                }
+            }
+        }
+    }
+}
+
+// connected components of HystLabel (root of the label of each pixel in the equivalence table) against
+// a flood fill of a weak (0x7F) / strong (0xFF) frame of HYST_TEST_WIDTH x HYST_TEST_HEIGHT: the pixels of
+// a component have one root, the components have different roots (but for the labels 0 and 1 of the
+// components that started after the table was full) and the root is strong if a pixel of it is
+static const int HYST_TEST_WIDTH  = 32;
+static const int HYST_TEST_HEIGHT = 24;
+
+template<uint32_t MAX_LABELS>
+bool HystLabelCheck(const std::vector<uint8_t>& hyst, bool& overflow) {
+    typedef hlsimproc::HlsImProc HlsImProc;
+    const int NUM_PIXELS = HYST_TEST_WIDTH * HYST_TEST_HEIGHT;
+    std::vector<hlsimproc::CompLabel> label_buf(NUM_PIXELS), label_root(MAX_LABELS);
+    bool label_strong[MAX_LABELS];
+    HlsImProc::HystLabel<HYST_TEST_WIDTH, HYST_TEST_HEIGHT, MAX_LABELS>(hyst.data(), label_buf.data(), label_root.data(),
+                                                                        label_strong, overflow);
+
+    std::vector<int> comp(NUM_PIXELS, -1), comp_root;
+    std::vector<bool> comp_strong;
+    std::vector<int> root_comp(MAX_LABELS, -1);
+    for(int i = 0; i < NUM_PIXELS; i++) {
+        if(hyst[i] == 0 || comp[i] >= 0) {
+            continue;
+        }
+        const int c = comp_root.size();
+        comp_root.push_back(label_root[label_buf[i]]);
+        comp_strong.push_back(false);
+        std::deque<int> queue(1, i);
+        comp[i] = c;
+        while(!queue.empty()) {
+            const int xi = queue.front() % HYST_TEST_WIDTH;
+            const int yi = queue.front() / HYST_TEST_WIDTH;
+            comp_strong[c] = comp_strong[c] || hyst[queue.front()] == 0xFF;
+            queue.pop_front();
+            for(int dy = -1; dy <= 1; dy++) {
+                for(int dx = -1; dx <= 1; dx++) {
+                    const int xn = xi + dx;
+                    const int yn = yi + dy;
+                    if(0 <= xn && xn < HYST_TEST_WIDTH && 0 <= yn && yn < HYST_TEST_HEIGHT &&
+                       hyst[xn + yn*HYST_TEST_WIDTH] != 0 && comp[xn + yn*HYST_TEST_WIDTH] < 0) {
+                        comp[xn + yn*HYST_TEST_WIDTH] = c;
+                        queue.push_back(xn + yn*HYST_TEST_WIDTH);
+                    }
+                }
+            }
+        }
+        if(comp_root[c] > 1) {
+            if(root_comp[comp_root[c]] >= 0) {
+                printf("hysteresis labelling merges two components at (%d, %d)\n", i % HYST_TEST_WIDTH, i / HYST_TEST_WIDTH);
+                return false;
+            }
+            root_comp[comp_root[c]] = c;
+        }
+    }
+    for(int i = 0; i < NUM_PIXELS; i++) {
+        const hlsimproc::CompLabel root = label_root[label_buf[i]];
+        const bool edge = (comp[i] >= 0) && comp_strong[comp[i]];
+        if((comp[i] >= 0 && root != comp_root[comp[i]]) || label_strong[root] != edge) {
+            printf("hysteresis labelling mismatch at (%d, %d)\n", i % HYST_TEST_WIDTH, i / HYST_TEST_WIDTH);
+            return false;
+        }
+    }
+    return true;
+}
+
+// strongest lines of an edge map as HoughAccumulate outputs them (data[11:0] rho bin, data[19:12] theta bin,
+// data[31:20] votes): the votes of every angle, the largest angle of each GradDir sector and rho (the lowest on a tie),
+// and the cells with the most votes in the order of (sector, rho) on a tie
+void HoughPeaksRef(const std::vector<uint8_t>& edge, const std::vector<hlsimproc::GradPix>& grad, uint32_t peaks[HOUGH_PEAKS]) {
+    typedef hlsimproc::HoughAccumulator<MAX_WIDTH, MAX_HEIGHT, HOUGH_THETA_BINS, HOUGH_RHO_SHIFT> Acc;
+    typedef hlsimproc::HoughTrig<HOUGH_THETA_BINS> Trig;
+    const int K = Acc::SECTOR_BINS;
+    std::vector<int> votes(HOUGH_THETA_BINS * Acc::RHO_BINS, 0);
+    for(int yi = 0; yi < MAX_HEIGHT; yi++) {
+        for(int xi = 0; xi < MAX_WIDTH; xi++) {
+            if(edge[xi + yi*MAX_WIDTH] != 0xFF) {
+                continue;
+            }
+            const int dir = (xi < 2 || yi < 2) ? 0 : hlsimproc::GradDirection(grad[(xi - 2) + (yi - 2)*MAX_WIDTH]);
+            for(int k = 0; k < K; k++) {
+                const int t = (dir*K + k + HOUGH_THETA_BINS - K / 2) % HOUGH_THETA_BINS;
+                const int rho = (xi * Trig::COS[t] + yi * Trig::SIN[t]) >> 14;
+                votes[t*Acc::RHO_BINS + ((rho + MAX_WIDTH) >> HOUGH_RHO_SHIFT)]++;
+            }
+        }
+    }
+    std::vector<std::pair<int, uint32_t> > cells; // (-votes, beat) in the order of (sector, rho)
+    for(int sector = 0; sector < 4; sector++) {
+        for(int rho_bin = 0; rho_bin < Acc::RHO_BINS; rho_bin++) {
+            int best = 0;
+            int best_t = 0;
+            for(int k = 0; k < K; k++) {
+                const int t = (sector*K + k + HOUGH_THETA_BINS - K / 2) % HOUGH_THETA_BINS;
+                if(k == 0 || votes[t*Acc::RHO_BINS + rho_bin] > best) {
+                    best = votes[t*Acc::RHO_BINS + rho_bin];
+                    best_t = t;
+                }
+            }
+            if(best > 0) {
+                cells.push_back(std::make_pair(-best, uint32_t(rho_bin | (best_t << 12) | (std::min(best, 4095) << 20))));
+            }
+        }
+    }
+    std::stable_sort(cells.begin(), cells.end(),
+                     [](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) { return a.first < b.first; });
+    for(int i = 0; i < HOUGH_PEAKS; i++) {
+        peaks[i] = (i < int(cells.size())) ? cells[i].second : 0;
+    }
+}
 
 int main() {
     hls::stream<ap_axiu<24,1,1,1> > gen_axis_in, gen_axis_out;
     hls::stream<hlsimproc::ImAxis<24> > im_axis_in, im_axis_out;
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_th, im_axis_out_th;
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_fused, im_axis_out_fused;
 
     // read image
     cv::Mat src = cv::imread(INPUT_IMAGE);
@@ -39,6 +615,7 @@ int main() {
     // convert axis type (ap_axiu -> hlsimproc::ImAxis)
     ap_axiu<24,1,1,1> gen_axis_reader;
     hlsimproc::ImAxis<24> im_axis_writer;
+    std::vector<uint32_t> frame(MAX_WIDTH * MAX_HEIGHT);
 
     for(int yi = 0; yi < MAX_HEIGHT; yi++) {
         for(int xi = 0; xi < MAX_WIDTH; xi++) {
@@ -49,13 +626,889 @@ int main() {
             im_axis_writer.last = gen_axis_reader.last;
 
             im_axis_in << im_axis_writer;
+            im_axis_in_th << im_axis_writer;
+            im_axis_in_fused << im_axis_writer;
+            frame[xi + yi*MAX_WIDTH] = gen_axis_reader.data.to_uint();
         }
     }
 
     // canny edge detection
     uint8_t hthr = CANNY_HTHR;
     uint8_t lthr = CANNY_LTHR;
-    canny_edge_detection(im_axis_in, im_axis_out, hthr, lthr);
+    uint32_t width = MAX_WIDTH;
+    uint32_t height = MAX_HEIGHT;
+    canny_edge_detection(im_axis_in, im_axis_out, hthr, lthr, width, height);
+
+    // same frame with one thread per DATAFLOW process
+    hlsimproc::FifoStats link_stats[NUM_FIFOS];
+    canny_edge_detection_csim_dataflow(im_axis_in_th, im_axis_out_th, hthr, lthr, width, height, link_stats);
+
+    // same frame with the fused filter stages
+    canny_edge_detection_fused(im_axis_in_fused, im_axis_out_fused, hthr, lthr, width, height);
+
+    // same frame with the multi-core host engine
+    std::vector<uint8_t> host_edge(MAX_WIDTH * MAX_HEIGHT);
+    hlsimproc::HostCannyEngine host_engine;
+    host_engine.Process(frame.data(), host_edge.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr);
+
+    // the same edge map with every instruction set of the host kernels the CPU supports
+    // (host_edge is checked against canny_edge_detection() below)
+    {
+        const hlsimproc::SimdLevel simd_levels[3] = { hlsimproc::SIMD_NONE, hlsimproc::SIMD_SSE41, hlsimproc::SIMD_AVX2 };
+        std::vector<uint8_t> simd_edge(MAX_WIDTH * MAX_HEIGHT);
+        for(int s = 0; s < 3 && simd_levels[s] <= hlsimproc::SupportedSimdLevel(); s++) {
+            hlsimproc::SetSimdLevel(simd_levels[s]);
+            host_engine.Process(frame.data(), simd_edge.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr);
+            if(simd_edge != host_edge) {
+                printf("host engine mismatch with SIMD level %d\n", s);
+                return 1;
+            }
+        }
+        hlsimproc::SetSimdLevel(hlsimproc::SupportedSimdLevel());
+    }
+
+    // the same edge map on 8 threads with strips of 1 row (halo taller than the strip),
+    // 3 rows and 37 rows (frame height not a multiple of the strip)
+    {
+        hlsimproc::HostCannyEngine strip_engine(8);
+        const uint32_t strip_rows[3] = { 1, 3, 37 };
+        std::vector<uint8_t> strip_edge(MAX_WIDTH * MAX_HEIGHT);
+        for(int s = 0; s < 3; s++) {
+            strip_engine.SetStripRows(strip_rows[s]);
+            strip_engine.Process(frame.data(), strip_edge.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr);
+            if(strip_engine.NumThreads() != 8 || strip_edge != host_edge) {
+                printf("host engine mismatch on 8 threads with %u rows per strip\n", strip_rows[s]);
+                return 1;
+            }
+        }
+    }
+
+    // same frame with multiple pixels per clock
+    hls::stream<hlsimproc::ImAxis<24, PIXELS_PER_CLOCK> > im_axis_in_ppc, im_axis_out_ppc;
+    std::vector<uint8_t> ppc_edge(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> ppc2_edge(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> ppc8_edge(MAX_WIDTH * MAX_HEIGHT);
+    PackBeats<PIXELS_PER_CLOCK>(frame, im_axis_in_ppc);
+    canny_edge_detection_ppc(im_axis_in_ppc, im_axis_out_ppc, hthr, lthr, width, height);
+    UnpackBeats<PIXELS_PER_CLOCK>(im_axis_out_ppc, ppc_edge);
+    CannyStagesPpc<2>(frame, ppc2_edge, hthr, lthr);
+    CannyStagesPpc<8>(frame, ppc8_edge, hthr, lthr);
+
+    // same frame with full hysteresis edge tracking
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_hyst, im_axis_out_hyst;
+    std::vector<uint8_t> hyst_edge(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> hyst_ref(MAX_WIDTH * MAX_HEIGHT);
+    PackBeats<1>(frame, im_axis_in_hyst);
+    bool hyst_overflow = true;
+    canny_edge_detection_hyst(im_axis_in_hyst, im_axis_out_hyst, hthr, lthr, width, height, hyst_overflow);
+    UnpackBeats<1>(im_axis_out_hyst, hyst_edge);
+    CannyFullHystRef(frame, hyst_ref, hthr, lthr);
+    if(hyst_overflow) {
+        printf("full hysteresis label table overflow\n");
+        return 1;
+    }
+
+    // random weak/strong frames (components that merge in every order), weak lines with a chain of merges
+    // in one line that the labels of the next line look up (resolved at the end of the line),
+    // and a frame of isolated pixels with more components than a table of 16 labels
+    {
+        uint32_t seed = 1;
+        std::vector<uint8_t> hyst_test(HYST_TEST_WIDTH * HYST_TEST_HEIGHT);
+        for(int f = 0; f < 200; f++) {
+            for(int i = 0; i < HYST_TEST_WIDTH * HYST_TEST_HEIGHT; i++) {
+                // random pixels, and diagonal lines that merge at their ends in every other frame
+                const int xi = i % HYST_TEST_WIDTH;
+                const int yi = i / HYST_TEST_WIDTH;
+                seed = seed * 1103515245 + 12345;
+                const uint32_t r = (seed >> 16) % 1000;
+                const bool line = (f % 2 == 1) && (xi * 7 + yi * 3 + (seed >> 8) % 3) % 5 == 0;
+                hyst_test[i] = (line || r < 10 * (f % 60)) ? ((r % 100 < f % 10) ? 0xFF : 0x7F) : 0;
+            }
+            bool overflow = true;
+            if(!HystLabelCheck<MAX_HYST_LABELS>(hyst_test, overflow)) {
+                return 1;
+            }
+            if(overflow) {
+                printf("hysteresis label table overflow on random frame %d\n", f);
+                return 1;
+            }
+        }
+        const char* merge_chain[6] = { "...................w.",
+                                       "............w.......w",
+                                       ".......w...w.....www.",
+                                       "....w.w..ww.w...w....",
+                                       "..ww.w.ww....w..w....",
+                                       "ww............ww....." };
+        for(int i = 0; i < HYST_TEST_WIDTH * HYST_TEST_HEIGHT; i++) {
+            const int xi = i % HYST_TEST_WIDTH;
+            const int yi = i / HYST_TEST_WIDTH;
+            hyst_test[i] = (yi < 6 && xi < 21 && merge_chain[yi][xi] == 'w') ? 0x7F : 0;
+        }
+        bool overflow = true;
+        if(!HystLabelCheck<MAX_HYST_LABELS>(hyst_test, overflow)) {
+            return 1;
+        }
+        for(int i = 0; i < HYST_TEST_WIDTH * HYST_TEST_HEIGHT; i++) {
+            const int xi = i % HYST_TEST_WIDTH;
+            const int yi = i / HYST_TEST_WIDTH;
+            hyst_test[i] = (xi % 2 == 0 && yi % 2 == 0) ? ((xi % 4 == 0) ? 0xFF : 0x7F) : 0;
+        }
+        overflow = false;
+        if(!HystLabelCheck<16>(hyst_test, overflow)) {
+            return 1;
+        }
+        if(!overflow) {
+            printf("hysteresis label table overflow not reported\n");
+            return 1;
+        }
+    }
+
+    // same frame three times with the adaptive thresholds: the 1st frame has no histogram
+    // (register values), the 2nd uses the thresholds of the 1st, the 3rd has them overridden
+    bool hist_auto = true;
+    uint8_t hist_pct = HIST_PCT;
+    uint8_t hist_ratio = HIST_RATIO;
+    std::vector<uint8_t> adaptive_edge[3];
+    for(int f = 0; f < 3; f++) {
+        hls::stream<hlsimproc::ImAxis<24> > im_axis_in_adaptive, im_axis_out_adaptive;
+        adaptive_edge[f].resize(MAX_WIDTH * MAX_HEIGHT);
+        hist_auto = (f != 2);
+        PackBeats<1>(frame, im_axis_in_adaptive);
+        canny_edge_detection_adaptive(im_axis_in_adaptive, im_axis_out_adaptive, hthr, lthr,
+                                      hist_auto, hist_pct, hist_ratio, width, height);
+        UnpackBeats<1>(im_axis_out_adaptive, adaptive_edge[f]);
+    }
+    uint8_t adaptive_hthr = hthr;
+    uint8_t adaptive_lthr = lthr;
+    std::vector<uint8_t> adaptive_ref(MAX_WIDTH * MAX_HEIGHT);
+    AdaptiveThresholdsRef(frame, hist_pct, hist_ratio, adaptive_hthr, adaptive_lthr);
+    host_engine.Process(frame.data(), adaptive_ref.data(), MAX_WIDTH, MAX_HEIGHT, adaptive_hthr, adaptive_lthr);
+    printf("adaptive thresholds: high %d, low %d\n", adaptive_hthr, adaptive_lthr);
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        if(adaptive_edge[0][i] != host_edge[i] || adaptive_edge[1][i] != adaptive_ref[i] ||
+           adaptive_edge[2][i] != host_edge[i]) {
+            printf("adaptive thresholds mismatch at (%d, %d)\n", i % MAX_WIDTH, i / MAX_WIDTH);
+            return 1;
+        }
+    }
+
+    // adaptive thresholds of a narrow frame, whose zero padded rows are fewer than the 256 beats
+    // the thresholds take to derive: crops of different columns of the frame one after another, each one
+    // with the thresholds of the one before it in every row
+    const int NUM_NARROW = 3;
+    const uint32_t NARROW_W = 16;
+    const uint32_t NARROW_H = 256;
+    const uint32_t NARROW_X[NUM_NARROW] = { 0, 240, 120 };
+    const uint32_t NARROW_Y = 200;
+    std::vector<uint32_t> narrow_frame[NUM_NARROW];
+    std::vector<uint32_t> narrow_packed(NARROW_W * NARROW_H);
+    std::vector<uint8_t> narrow_edge(NARROW_W * NARROW_H), narrow_ref(NARROW_W * NARROW_H);
+    uint32_t narrow_width = NARROW_W;
+    uint32_t narrow_height = NARROW_H;
+    hist_auto = true;
+    for(int f = 0; f < NUM_NARROW; f++) {
+        narrow_frame[f].assign(MAX_WIDTH * MAX_HEIGHT, 0);
+        for(uint32_t yi = 0; yi < NARROW_H; yi++) {
+            for(uint32_t xi = 0; xi < NARROW_W; xi++) {
+                narrow_frame[f][xi + yi*MAX_WIDTH] = frame[(NARROW_X[f] + xi) + (NARROW_Y + yi)*MAX_WIDTH];
+                narrow_packed[xi + yi*NARROW_W] = narrow_frame[f][xi + yi*MAX_WIDTH];
+            }
+        }
+        hls::stream<hlsimproc::ImAxis<24> > im_axis_in_narrow, im_axis_out_narrow;
+        PackBeats<1>(narrow_frame[f], im_axis_in_narrow, NARROW_W, NARROW_H);
+        canny_edge_detection_adaptive(im_axis_in_narrow, im_axis_out_narrow, hthr, lthr,
+                                      hist_auto, hist_pct, hist_ratio, narrow_width, narrow_height);
+        for(uint32_t i = 0; i < NARROW_W * NARROW_H; i++) {
+            narrow_edge[i] = im_axis_out_narrow.read().data & 0xff;
+        }
+        if(f == 0) {
+            continue;
+        }
+        uint8_t narrow_hthr = hthr;
+        uint8_t narrow_lthr = lthr;
+        AdaptiveThresholdsRef(narrow_frame[f - 1], hist_pct, hist_ratio, narrow_hthr, narrow_lthr, NARROW_W, NARROW_H);
+        host_engine.Process(narrow_packed.data(), narrow_ref.data(), NARROW_W, NARROW_H, narrow_hthr, narrow_lthr);
+        printf("narrow adaptive thresholds of crop %d: high %d, low %d\n", f - 1, narrow_hthr, narrow_lthr);
+        for(uint32_t i = 0; i < NARROW_W * NARROW_H; i++) {
+            if(narrow_edge[i] != narrow_ref[i]) {
+                printf("narrow adaptive thresholds mismatch at (%d, %d) of crop %d\n",
+                       int(i % NARROW_W), int(i / NARROW_W), f);
+                return 1;
+            }
+        }
+    }
+
+    // three frames back-to-back (the 2nd mirrored) in one call of the continuous mode
+    const int NUM_CONT_FRAMES = 3;
+    std::vector<uint32_t> mirror_frame(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> mirror_edge(MAX_WIDTH * MAX_HEIGHT);
+    for(int yi = 0; yi < MAX_HEIGHT; yi++) {
+        for(int xi = 0; xi < MAX_WIDTH; xi++) {
+            mirror_frame[xi + yi*MAX_WIDTH] = frame[(MAX_WIDTH - 1 - xi) + yi*MAX_WIDTH];
+        }
+    }
+    host_engine.Process(mirror_frame.data(), mirror_edge.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr);
+
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_cont, im_axis_out_cont;
+    uint32_t num_frames = NUM_CONT_FRAMES;
+    for(int f = 0; f < NUM_CONT_FRAMES; f++) {
+        PackBeats<1>((f == 1) ? mirror_frame : frame, im_axis_in_cont);
+    }
+    canny_edge_detection_continuous(im_axis_in_cont, im_axis_out_cont, hthr, lthr, width, height, num_frames);
+    if(im_axis_out_cont.size() != NUM_CONT_FRAMES * MAX_WIDTH * MAX_HEIGHT) {
+        printf("continuous mode has %d pixels\n", int(im_axis_out_cont.size()));
+        return 1;
+    }
+    for(int f = 0; f < NUM_CONT_FRAMES; f++) {
+        std::vector<uint8_t> cont_edge(MAX_WIDTH * MAX_HEIGHT);
+        UnpackBeats<1>(im_axis_out_cont, cont_edge);
+        const std::vector<uint8_t>& cont_ref = (f == 1) ? mirror_edge : host_edge;
+        for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+            if(cont_edge[i] != cont_ref[i]) {
+                printf("continuous mode mismatch at (%d, %d) of frame %d\n", i % MAX_WIDTH, i / MAX_WIDTH, f);
+                return 1;
+            }
+        }
+    }
+
+    // cycle model of the dataflow simulation, which runs the frame loop of every stage of the
+    // continuous mode (RunStageFrames) on its own thread. The model starts every call at cycle 0,
+    // so one frame per call only gives the fill latency (cycle of the first output pixel), a lower
+    // bound of the gap between two calls, not a measured gap; the continuous mode gives the idle
+    // cycles between the last output pixel of a frame and the first one of the next
+    std::vector<uint64_t> single_cycles;
+    std::vector<uint64_t> cont_cycles;
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_gap, im_axis_out_gap;
+    PackBeats<1>(frame, im_axis_in_gap);
+    canny_edge_detection_csim_dataflow(im_axis_in_gap, im_axis_out_gap, hthr, lthr, width, height,
+                                       NULL, 1, &single_cycles);
+    while(!im_axis_out_gap.empty()) {
+        im_axis_out_gap.read();
+    }
+    for(int f = 0; f < NUM_CONT_FRAMES; f++) {
+        PackBeats<1>(frame, im_axis_in_gap);
+    }
+    canny_edge_detection_csim_dataflow(im_axis_in_gap, im_axis_out_gap, hthr, lthr, width, height,
+                                       NULL, NUM_CONT_FRAMES, &cont_cycles);
+    while(!im_axis_out_gap.empty()) {
+        im_axis_out_gap.read();
+    }
+    uint64_t max_cont_gap = 0;
+    for(int f = 1; f < NUM_CONT_FRAMES; f++) {
+        const int first = f * MAX_WIDTH * MAX_HEIGHT;
+        max_cont_gap = std::max(max_cont_gap, cont_cycles[first] - cont_cycles[first - 1] - 1);
+    }
+    printf("fill latency of one frame per call %llu cycles, inter-frame gap of the continuous mode %llu cycles\n",
+           (unsigned long long)single_cycles[0], (unsigned long long)max_cont_gap);
+    if(max_cont_gap >= single_cycles[0]) {
+        printf("continuous mode does not overlap the frames\n");
+        return 1;
+    }
+
+    // MAX_STREAMS sources (the frame, mirrored, upside down and inverted) with their own thresholds
+    // through one pipeline, interleaved line by line and then frame by frame
+    std::vector<uint32_t> stream_frame[MAX_STREAMS];
+    std::vector<uint8_t> stream_ref[MAX_STREAMS];
+    uint8_t stream_hthr[MAX_STREAMS];
+    uint8_t stream_lthr[MAX_STREAMS];
+    for(int si = 0; si < MAX_STREAMS; si++) {
+        stream_frame[si].resize(MAX_WIDTH * MAX_HEIGHT);
+        stream_ref[si].resize(MAX_WIDTH * MAX_HEIGHT);
+        for(int yi = 0; yi < MAX_HEIGHT; yi++) {
+            for(int xi = 0; xi < MAX_WIDTH; xi++) {
+                const int mx = (si == 1) ? MAX_WIDTH - 1 - xi : xi;
+                const int my = (si == 2) ? MAX_HEIGHT - 1 - yi : yi;
+                const uint32_t pix = frame[mx + my*MAX_WIDTH];
+                stream_frame[si][xi + yi*MAX_WIDTH] = (si == 3) ? (~pix & 0xffffff) : pix;
+            }
+        }
+        stream_hthr[si] = hthr + 10*si;
+        stream_lthr[si] = lthr + 5*si;
+        host_engine.Process(stream_frame[si].data(), stream_ref[si].data(), MAX_WIDTH, MAX_HEIGHT,
+                            stream_hthr[si], stream_lthr[si]);
+    }
+    for(int mode = 0; mode < 2; mode++) {
+        hls::stream<hlsimproc::ImAxis<24, 1, STREAM_DEST_W> > im_axis_in_multi, im_axis_out_multi;
+        for(int i = 0; i < MAX_STREAMS * MAX_HEIGHT; i++) {
+            // line interleaved : line i / MAX_STREAMS of each stream in turn (the last stream first)
+            // frame interleaved : all the lines of a stream, and then the next stream
+            const int si = (mode == 0) ? MAX_STREAMS - 1 - i % MAX_STREAMS : i / MAX_HEIGHT;
+            const int yi = (mode == 0) ? i / MAX_STREAMS : i % MAX_HEIGHT;
+            PackStreamLine(stream_frame[si], yi, si, im_axis_in_multi);
+        }
+        canny_edge_detection_multi(im_axis_in_multi, im_axis_out_multi, stream_hthr, stream_lthr, width, height);
+
+        std::vector<uint8_t> multi_edge[MAX_STREAMS];
+        for(int si = 0; si < MAX_STREAMS; si++) {
+            multi_edge[si].resize(MAX_WIDTH * MAX_HEIGHT);
+        }
+        if(!UnpackStreams(im_axis_out_multi, multi_edge)) {
+            printf("multi-stream %s interleaved output has wrong TDEST/TUSER/TLAST\n", (mode == 0) ? "line" : "frame");
+            return 1;
+        }
+        for(int si = 0; si < MAX_STREAMS; si++) {
+            for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+                if(multi_edge[si][i] != stream_ref[si][i]) {
+                    printf("multi-stream %s interleaved mismatch at (%d, %d) of stream %d\n",
+                           (mode == 0) ? "line" : "frame", i % MAX_WIDTH, i / MAX_WIDTH, si);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // same frame with the edge map packed to 1 bit per pixel, the strong/weak map
+    // (HystThreshold output) packed to 2 bits per pixel, and only the edge pixels
+    std::vector<hlsimproc::GradPix> grad_ref(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> hyst_thr(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> packed_code(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> packed2_code(MAX_WIDTH * MAX_HEIGHT);
+    CannyStagesGrad(frame, grad_ref, hyst_thr, hthr, lthr);
+
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_packed;
+    hls::stream<hlsimproc::ImAxis<PACKED_BEAT_W> > im_axis_out_packed;
+    PackBeats<1>(frame, im_axis_in_packed);
+    canny_edge_detection_packed(im_axis_in_packed, im_axis_out_packed, hthr, lthr, width, height);
+    const int num_packed_beats = im_axis_out_packed.size();
+    if(!UnpackPacked<1, PACKED_BEAT_W>(im_axis_out_packed, packed_code)) {
+        printf("packed output has wrong beats\n");
+        return 1;
+    }
+    hls::stream<hlsimproc::ImAxis<PACKED_BEAT_W> > im_axis_out_packed2;
+    hlsimproc::HlsImProc::GrayArray2AXISPacked<MAX_WIDTH, MAX_HEIGHT, 2, PACKED_BEAT_W>(hyst_thr.data(), im_axis_out_packed2);
+    if(!UnpackPacked<2, PACKED_BEAT_W>(im_axis_out_packed2, packed2_code)) {
+        printf("2 bit packed output has wrong beats\n");
+        return 1;
+    }
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        const int code2 = (hyst_thr[i] == 0xFF) ? 3 : (hyst_thr[i] != 0) ? 1 : 0;
+        if(packed_code[i] != (host_edge[i] == 0xFF) || packed2_code[i] != code2) {
+            printf("packed output mismatch at (%d, %d)\n", i % MAX_WIDTH, i / MAX_WIDTH);
+            return 1;
+        }
+    }
+
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_sparse;
+    hls::stream<hlsimproc::ImAxis<32> > im_axis_out_sparse;
+    PackBeats<1>(frame, im_axis_in_sparse);
+    canny_edge_detection_sparse(im_axis_in_sparse, im_axis_out_sparse, hthr, lthr, width, height);
+    const int num_sparse_beats = im_axis_out_sparse.size();
+    int sparse_pos = 0;
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        if(host_edge[i] != 0xFF) {
+            continue;
+        }
+        // edge pixels in raster order with the direction of their gradient
+        const int xi = i % MAX_WIDTH;
+        const int yi = i / MAX_WIDTH;
+        hlsimproc::ImAxis<32> axis_reader;
+        im_axis_out_sparse >> axis_reader;
+        const int dir = hlsimproc::GradDirection(grad_ref[(xi - 2) + (yi - 2)*MAX_WIDTH]);
+        if(axis_reader.data.range(11, 0) != xi || axis_reader.data.range(23, 12) != yi ||
+           axis_reader.data.range(25, 24) != dir || axis_reader.data.range(31, 26) != 0 ||
+           axis_reader.user != (sparse_pos == 0) || axis_reader.last != 0) {
+            printf("sparse output mismatch at (%d, %d)\n", xi, yi);
+            return 1;
+        }
+        sparse_pos++;
+    }
+    hlsimproc::ImAxis<32> sparse_eof;
+    im_axis_out_sparse >> sparse_eof;
+    if(sparse_eof.data != (0x80000000u | sparse_pos) || sparse_eof.last != 1 || !im_axis_out_sparse.empty()) {
+        printf("sparse output has a wrong end of frame\n");
+        return 1;
+    }
+    printf("output beats: dense %d x 24 bits, packed %d x %d bits, sparse %d x 32 bits (%d edge pixels)\n",
+           MAX_WIDTH * MAX_HEIGHT, num_packed_beats, PACKED_BEAT_W, num_sparse_beats, sparse_pos);
+
+    // same frame as Y8, YUV 4:2:2 (Y is the luma of the RGB frame) and raw Bayer RGGB
+    std::vector<uint8_t> gray_ref(MAX_WIDTH * MAX_HEIGHT);
+    {
+        hls::stream<hlsimproc::ImAxis<24> > im_axis_in_gray;
+        PackBeats<1>(frame, im_axis_in_gray);
+        hlsimproc::HlsImProc::AXIS2GrayArray<MAX_WIDTH, MAX_HEIGHT>(im_axis_in_gray, gray_ref.data());
+    }
+    std::vector<uint32_t> y8_frame(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint32_t> yuv_frame(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint32_t> bayer_frame(MAX_WIDTH * MAX_HEIGHT);
+    for(int yi = 0; yi < MAX_HEIGHT; yi++) {
+        for(int xi = 0; xi < MAX_WIDTH; xi++) {
+            const uint32_t pix = frame[xi + yi*MAX_WIDTH];
+            const uint32_t pix_b = pix & 0xff;
+            const uint32_t pix_g = (pix >> 8) & 0xff;
+            const uint32_t pix_r = (pix >> 16) & 0xff;
+            y8_frame[xi + yi*MAX_WIDTH] = gray_ref[xi + yi*MAX_WIDTH];
+            yuv_frame[xi + yi*MAX_WIDTH] = ((xi % 2 == 0) ? pix_b : pix_r) << 8 | gray_ref[xi + yi*MAX_WIDTH];
+            bayer_frame[xi + yi*MAX_WIDTH] = (xi % 2 == 0 && yi % 2 == 0) ? pix_r :
+                                             (xi % 2 == 1 && yi % 2 == 1) ? pix_b : pix_g;
+        }
+    }
+    std::vector<uint8_t> format_luma(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> format_edge(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> bayer_g_luma(MAX_WIDTH * MAX_HEIGHT), bayer_g_edge(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> bayer_bin_luma(MAX_WIDTH * MAX_HEIGHT), bayer_bin_edge(MAX_WIDTH * MAX_HEIGHT);
+    BayerLumaRef(bayer_frame, true, bayer_g_luma);
+    BayerLumaRef(bayer_frame, false, bayer_bin_luma);
+    CannyStagesGray(bayer_g_luma, bayer_g_edge, hthr, lthr);
+    CannyStagesGray(bayer_bin_luma, bayer_bin_edge, hthr, lthr);
+    for(int fmt = 0; fmt < 6; fmt++) {
+        const char* fmt_name[6] = { "Y8", "YUV 4:2:2", "Bayer green", "Bayer green (4 pixels per clock)",
+                                    "Bayer binned", "Bayer binned (4 pixels per clock)" };
+        const std::vector<uint8_t>* luma_ref[6] = { &gray_ref, &gray_ref, &bayer_g_luma, &bayer_g_luma,
+                                                    &bayer_bin_luma, &bayer_bin_luma };
+        const std::vector<uint8_t>* edge_ref[6] = { &host_edge, &host_edge, &bayer_g_edge, &bayer_g_edge,
+                                                    &bayer_bin_edge, &bayer_bin_edge };
+        switch(fmt) {
+            case 0: CannyStagesFormat<hlsimproc::PIX_Y8, 1>(y8_frame, format_luma, format_edge, hthr, lthr); break;
+            case 1: CannyStagesFormat<hlsimproc::PIX_YUV422, 1>(yuv_frame, format_luma, format_edge, hthr, lthr); break;
+            case 2: CannyStagesFormat<hlsimproc::PIX_BAYER_G, 1>(bayer_frame, format_luma, format_edge, hthr, lthr); break;
+            case 3: CannyStagesFormat<hlsimproc::PIX_BAYER_G, 4>(bayer_frame, format_luma, format_edge, hthr, lthr); break;
+            case 4: CannyStagesFormat<hlsimproc::PIX_BAYER_BIN, 1>(bayer_frame, format_luma, format_edge, hthr, lthr); break;
+            default: CannyStagesFormat<hlsimproc::PIX_BAYER_BIN, 4>(bayer_frame, format_luma, format_edge, hthr, lthr); break;
+        }
+        for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+            if(format_luma[i] != (*luma_ref[fmt])[i] || format_edge[i] != (*edge_ref[fmt])[i]) {
+                printf("%s input mismatch at (%d, %d)\n", fmt_name[fmt], i % MAX_WIDTH, i / MAX_WIDTH);
+                return 1;
+            }
+        }
+    }
+
+    // same frame through the top function of INPUT_FORMAT
+    hls::stream<hlsimproc::ImAxis<hlsimproc::PixFormatBits<INPUT_FORMAT>::value> > im_axis_in_luma;
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_out_luma;
+    std::vector<uint8_t> luma_edge(MAX_WIDTH * MAX_HEIGHT);
+    const hlsimproc::PixFormat input_format = INPUT_FORMAT;
+    PackBeats<1>((input_format == hlsimproc::PIX_RGB24) ? frame :
+                 (input_format == hlsimproc::PIX_Y8) ? y8_frame :
+                 (input_format == hlsimproc::PIX_YUV422) ? yuv_frame : bayer_frame, im_axis_in_luma);
+    canny_edge_detection_luma(im_axis_in_luma, im_axis_out_luma, hthr, lthr, width, height);
+    UnpackBeats<1>(im_axis_out_luma, luma_edge);
+    if(luma_edge != ((input_format == hlsimproc::PIX_BAYER_G) ? bayer_g_edge :
+                     (input_format == hlsimproc::PIX_BAYER_BIN) ? bayer_bin_edge : host_edge)) {
+        printf("luma input top function mismatch\n");
+        return 1;
+    }
+
+    // separable Gaussian kernels of each size, binomial and with sigma
+    if(!GaussianKernelCheck<3, 0, 1>(gray_ref) || !GaussianKernelCheck<5, 0, 4>(gray_ref) ||
+       !GaussianKernelCheck<7, 0, 1>(gray_ref) || !GaussianKernelCheck<5, 100, 1>(gray_ref) ||
+       !GaussianKernelCheck<7, 150, 2>(gray_ref)) {
+        return 1;
+    }
+
+    // same frame with the approximations of the gradient magnitude
+    std::vector<uint8_t> isqrt_edge(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> l1_edge(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> ambm_edge(MAX_WIDTH * MAX_HEIGHT);
+    CannyStagesMag<hlsimproc::MAG_ISQRT>(frame, isqrt_edge, hthr, lthr);
+    CannyStagesMag<hlsimproc::MAG_L1>(frame, l1_edge, hthr, lthr);
+    CannyStagesMag<hlsimproc::MAG_AMBM>(frame, ambm_edge, hthr, lthr);
+
+    int num_comp_edges = 0;
+    int num_hyst_edges = 0;
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        num_comp_edges += (host_edge[i] == 0xFF);
+        num_hyst_edges += (hyst_edge[i] == 0xFF);
+    }
+    printf("edge pixels: 3x3 comparison %d, full hysteresis %d\n", num_comp_edges, num_hyst_edges);
+
+    // edge map deviation of each magnitude mode from MAG_EXACT (MAG_ISQRT must be 0)
+    int num_isqrt_diffs = 0;
+    int num_l1_diffs = 0;
+    int num_ambm_diffs = 0;
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        num_isqrt_diffs += (isqrt_edge[i] != host_edge[i]);
+        num_l1_diffs += (l1_edge[i] != host_edge[i]);
+        num_ambm_diffs += (ambm_edge[i] != host_edge[i]);
+    }
+    printf("magnitude mode deviation: isqrt %d, L1 %d, alpha max plus beta min %d pixels (%.3f%%, %.3f%%, %.3f%%)\n",
+           num_isqrt_diffs, num_l1_diffs, num_ambm_diffs,
+           100.0 * num_isqrt_diffs / (MAX_WIDTH * MAX_HEIGHT),
+           100.0 * num_l1_diffs / (MAX_WIDTH * MAX_HEIGHT),
+           100.0 * num_ambm_diffs / (MAX_WIDTH * MAX_HEIGHT));
+    if(num_isqrt_diffs != 0) {
+        printf("integer square root mismatch\n");
+        return 1;
+    }
+
+    // counters of the AXI4-Stream monitors: a frame with beats before the start of frame,
+    // a short line and a long line (same output as canny_edge_detection() on it), and then the frame
+    const int NUM_DISCARD = 5;
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_perf, im_axis_out_perf;
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_bad, im_axis_out_bad;
+    std::vector<uint8_t> perf_edge(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> bad_edge(MAX_WIDTH * MAX_HEIGHT);
+    hlsimproc::PerfCounters perf = {0, 0, 0, 0, 0, 0, 0};
+    PackMalformed(frame, NUM_DISCARD, 100, 3, 200, 2, im_axis_in_perf);
+    PackMalformed(frame, NUM_DISCARD, 100, 3, 200, 2, im_axis_in_bad);
+    canny_edge_detection_perf(im_axis_in_perf, im_axis_out_perf, hthr, lthr, width, height, perf);
+    canny_edge_detection(im_axis_in_bad, im_axis_out_bad, hthr, lthr, width, height);
+    UnpackBeats<1>(im_axis_out_perf, perf_edge);
+    UnpackBeats<1>(im_axis_out_bad, bad_edge);
+    if(perf_edge != bad_edge || !im_axis_in_perf.empty()) {
+        printf("monitored frame mismatch\n");
+        return 1;
+    }
+    PackBeats<1>(frame, im_axis_in_perf);
+    canny_edge_detection_perf(im_axis_in_perf, im_axis_out_perf, hthr, lthr, width, height, perf);
+    UnpackBeats<1>(im_axis_out_perf, perf_edge);
+    printf("perf counters: frames %u, SOF discarded %u, short lines %u, long lines %u, "
+           "input stalls %u, output stalls %u, edge pixels %u\n",
+           perf.frames, perf.sof_discarded, perf.short_lines, perf.long_lines,
+           perf.in_stalls, perf.out_stalls, perf.edge_pixels);
+    if(perf_edge != host_edge || perf.frames != 2 || perf.sof_discarded != NUM_DISCARD ||
+       perf.short_lines != 1 || perf.long_lines != 1 || perf.in_stalls != 0 || perf.out_stalls != 0 ||
+       perf.edge_pixels != uint32_t(num_comp_edges)) {
+        printf("perf counters mismatch\n");
+        return 1;
+    }
+
+    // the host engine returns the same counters for the frame
+    hlsimproc::PerfCounters host_perf = {0, 0, 0, 0, 0, 0, 0};
+    host_engine.Process(frame.data(), perf_edge.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr, &host_perf);
+    if(host_perf.frames != 1 || host_perf.edge_pixels != perf.edge_pixels) {
+        printf("host perf counters mismatch\n");
+        return 1;
+    }
+
+    // stall counters of the monitors in the dataflow model: a source with a beat every other cycle
+    // starves the input monitor for a cycle after each beat of the frame but the first one, and a sink
+    // that reads every other cycle back-pressures the output monitor (every beat still goes through)
+    const uint32_t FRAME_PIXELS = MAX_WIDTH * MAX_HEIGHT;
+    uint32_t num_frame_edges = 0;
+    for(uint32_t i = 0; i < FRAME_PIXELS; i++) {
+        num_frame_edges += ((frame[i] & 0xFF) == 0xFF);
+    }
+    hlsimproc::PerfCounters starved_perf = {0, 0, 0, 0, 0, 0, 0};
+    hlsimproc::PerfCounters pressed_perf = {0, 0, 0, 0, 0, 0, 0};
+    std::vector<uint32_t> starved_out(FRAME_PIXELS), pressed_out(FRAME_PIXELS);
+    MonitorDataflow(frame, 2, 1, starved_perf, starved_out);
+    MonitorDataflow(frame, 1, 2, pressed_perf, pressed_out);
+    printf("monitor stalls: slow source input %u/output %u, slow sink input %u/output %u\n",
+           starved_perf.in_stalls, starved_perf.out_stalls, pressed_perf.in_stalls, pressed_perf.out_stalls);
+    if(starved_out != frame || pressed_out != frame ||
+       starved_perf.frames != 1 || starved_perf.edge_pixels != num_frame_edges ||
+       starved_perf.in_stalls != FRAME_PIXELS - 1 || starved_perf.out_stalls != 0 ||
+       pressed_perf.frames != 1 || pressed_perf.edge_pixels != num_frame_edges ||
+       pressed_perf.in_stalls != 0 || pressed_perf.out_stalls == 0) {
+        printf("monitor stall counters mismatch\n");
+        return 1;
+    }
+
+    // region of interest: the output is the ROI of the full frame output (inside the frame,
+    // at its right/bottom edge, at its top/left corner with the full width, near its left edge
+    // and at its top/left corner without reaching the right edge, and near both edges), and only the ROI is output
+    const int NUM_ROIS = 6;
+    const uint32_t ROIS[NUM_ROIS][4] = { { 100, 60, 200, 150 }, { 300, 400, 212, 112 }, { 0, 0, MAX_WIDTH, 40 },
+                                         { 4, 200, 120, 80 }, { 0, 0, 64, 30 }, { 3, 100, MAX_WIDTH - 8, 20 } };
+    for(int r = 0; r < NUM_ROIS; r++) {
+        uint32_t roi_x = ROIS[r][0];
+        uint32_t roi_y = ROIS[r][1];
+        uint32_t roi_width = ROIS[r][2];
+        uint32_t roi_height = ROIS[r][3];
+        hls::stream<hlsimproc::ImAxis<24> > im_axis_in_roi, im_axis_out_roi;
+        PackBeats<1>(frame, im_axis_in_roi);
+        canny_edge_detection_roi(im_axis_in_roi, im_axis_out_roi, hthr, lthr, width, height,
+                                 roi_x, roi_y, roi_width, roi_height);
+        if(im_axis_out_roi.size() != roi_width * roi_height || !im_axis_in_roi.empty()) {
+            printf("ROI %d x %d at (%d, %d) has %d pixels\n", int(roi_width), int(roi_height),
+                   int(roi_x), int(roi_y), int(im_axis_out_roi.size()));
+            return 1;
+        }
+        for(uint32_t yi = 0; yi < roi_height; yi++) {
+            for(uint32_t xi = 0; xi < roi_width; xi++) {
+                hlsimproc::ImAxis<24> roi_reader;
+                im_axis_out_roi >> roi_reader;
+                if(host_edge[(roi_x + xi) + (roi_y + yi)*MAX_WIDTH] != (roi_reader.data & 0xff) ||
+                   roi_reader.user != (xi == 0 && yi == 0) || roi_reader.last != (xi == roi_width - 1)) {
+                    printf("ROI %d x %d at (%d, %d) mismatch at (%d, %d)\n", int(roi_width), int(roi_height),
+                           int(roi_x), int(roi_y), int(xi), int(yi));
+                    return 1;
+                }
+            }
+        }
+        const hlsimproc::StageArgs roi_args = hlsimproc::RoiStageArgs(roi_x, roi_y, roi_width, roi_height, width, height,
+                                                                      ROI_HALO, ROI_MARGIN, hthr, lthr, 5);
+        printf("ROI %d x %d at (%d, %d): stages on %d x %d pixels (%.1f%% of the frame)\n",
+               int(roi_width), int(roi_height), int(roi_x), int(roi_y), int(roi_args.width), int(roi_args.height),
+               100.0 * roi_args.width * roi_args.height / (MAX_WIDTH * MAX_HEIGHT));
+    }
+
+    // incremental mode: the same frame again recomputes nothing, a changed patch recomputes the tiles around it,
+    // and the output is the same as Process(); the tile change map of canny_edge_detection_tiles() matches
+    // the tiles the host engine finds changed, and ProcessIncremental() on that map gives the same output
+    std::vector<uint32_t> patched(frame);
+    for(int yi = 300; yi < 330; yi++) {
+        for(int xi = 200; xi < 240; xi++) {
+            patched[xi + yi*MAX_WIDTH] ^= 0xffffff;
+        }
+    }
+    std::vector<uint8_t> patched_edge(MAX_WIDTH * MAX_HEIGHT);
+    host_engine.Process(patched.data(), patched_edge.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr);
+
+    hlsimproc::HostCannyEngine inc_engine;
+    inc_engine.SetTileSize(TILE_WIDTH, TILE_HEIGHT);
+    hlsimproc::IncrementalStats inc_stats[4];
+    std::vector<uint8_t> inc_edge[4];
+    const std::vector<uint32_t>* inc_frames[4] = { &frame, &frame, &patched, &frame };
+    const std::vector<uint8_t>* inc_refs[4] = { &host_edge, &host_edge, &patched_edge, &host_edge };
+    uint8_t tile_changed[3][MAX_TILES];
+    for(int f = 0; f < 3; f++) {
+        hls::stream<hlsimproc::ImAxis<24> > im_axis_in_tiles, im_axis_out_tiles;
+        PackBeats<1>(*inc_frames[f + 1], im_axis_in_tiles);
+        canny_edge_detection_tiles(im_axis_in_tiles, im_axis_out_tiles, hthr, lthr, width, height, tile_changed[f]);
+        std::vector<uint8_t> tiles_edge(MAX_WIDTH * MAX_HEIGHT);
+        UnpackBeats<1>(im_axis_out_tiles, tiles_edge);
+        if(tiles_edge != *inc_refs[f + 1]) {
+            printf("tile change frame %d mismatch\n", f);
+            return 1;
+        }
+    }
+    for(int f = 0; f < 4; f++) {
+        inc_edge[f].resize(MAX_WIDTH * MAX_HEIGHT);
+        // the last frame uses the change map of the hardware
+        inc_engine.ProcessIncremental(inc_frames[f]->data(), inc_edge[f].data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr,
+                                      (f == 3) ? tile_changed[2] : NULL, &inc_stats[f]);
+        if(inc_edge[f] != *inc_refs[f]) {
+            printf("incremental frame %d mismatch\n", f);
+            return 1;
+        }
+        if(f == 2) {
+            for(int i = 0; i < MAX_TILES; i++) {
+                if(tile_changed[1][i] != inc_engine.TileChanged()[i]) {
+                    printf("tile change map mismatch at tile %d\n", i);
+                    return 1;
+                }
+            }
+        }
+        printf("incremental frame %d: %u of %u tiles changed, %u recomputed\n", f,
+               inc_stats[f].changed_tiles, inc_stats[f].tiles, inc_stats[f].recomputed_tiles);
+    }
+    if(inc_stats[1].recomputed_tiles != 0 || inc_stats[2].changed_tiles == 0 ||
+       inc_stats[3].changed_tiles != inc_stats[2].changed_tiles) {
+        printf("incremental tiles mismatch\n");
+        return 1;
+    }
+
+    // two changes of one tile that cancel out in a sum of its pixels and in a sum of the running sums
+    // (+128 and -128 of the luma 16 lines, i.e. 512 pixels of the tile, apart) are in the tile change map,
+    // and ProcessIncremental() on it gives the same output as Process()
+    {
+        // luma of the gray pixels (40, 40, 40) : 41 -> (165, 165, 165) : 169, and (195, 195, 195) : 200 -> (70, 70, 70) : 72
+        std::vector<uint32_t> comp_base(frame), comp_frame(frame);
+        const int comp_x = 70;
+        const int comp_y = 100;
+        comp_base[comp_x + comp_y*MAX_WIDTH]         = 40 * 0x010101;
+        comp_frame[comp_x + comp_y*MAX_WIDTH]        = 165 * 0x010101;
+        comp_base[comp_x + (comp_y + 16)*MAX_WIDTH]  = 195 * 0x010101;
+        comp_frame[comp_x + (comp_y + 16)*MAX_WIDTH] = 70 * 0x010101;
+        const int comp_tile = comp_x / TILE_WIDTH + (comp_y / TILE_HEIGHT) * ((MAX_WIDTH + TILE_WIDTH - 1) / TILE_WIDTH);
+        const std::vector<uint32_t>* comp_frames[2] = { &comp_base, &comp_frame };
+        uint8_t comp_changed[MAX_TILES];
+        std::vector<uint8_t> comp_edge(MAX_WIDTH * MAX_HEIGHT), comp_ref(MAX_WIDTH * MAX_HEIGHT);
+        for(int f = 0; f < 2; f++) {
+            hls::stream<hlsimproc::ImAxis<24> > im_axis_in_tiles, im_axis_out_tiles;
+            PackBeats<1>(*comp_frames[f], im_axis_in_tiles);
+            canny_edge_detection_tiles(im_axis_in_tiles, im_axis_out_tiles, hthr, lthr, width, height, comp_changed);
+            UnpackBeats<1>(im_axis_out_tiles, comp_edge);
+            inc_engine.ProcessIncremental(comp_frames[f]->data(), comp_edge.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr,
+                                          (f == 1) ? comp_changed : NULL);
+        }
+        for(int i = 0; i < MAX_TILES; i++) {
+            if(comp_changed[i] != (i == comp_tile)) {
+                printf("compensating tile change mismatch at tile %d\n", i);
+                return 1;
+            }
+        }
+        host_engine.Process(comp_frame.data(), comp_ref.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr);
+        if(comp_edge != comp_ref) {
+            printf("compensating tile change incremental mismatch\n");
+            return 1;
+        }
+    }
+
+    // Hough lines: the edge map is the same as canny_edge_detection(), the peaks are the ones of the edge map
+    // (also after a frame with other lines, so the accumulator is cleared at the end of each frame),
+    // and the four edges of a rectangle are the four strongest lines at 0° or 90°
+    std::vector<uint32_t> rect(MAX_WIDTH * MAX_HEIGHT, 0);
+    for(int yi = 150; yi < 350; yi++) {
+        for(int xi = 100; xi < 400; xi++) {
+            rect[xi + yi*MAX_WIDTH] = 0xffffff;
+        }
+    }
+    std::vector<uint8_t> rect_edge(MAX_WIDTH * MAX_HEIGHT);
+    host_engine.Process(rect.data(), rect_edge.data(), MAX_WIDTH, MAX_HEIGHT, hthr, lthr);
+    std::vector<hlsimproc::GradPix> rect_grad(MAX_WIDTH * MAX_HEIGHT);
+    std::vector<uint8_t> rect_hyst(MAX_WIDTH * MAX_HEIGHT);
+    CannyStagesGrad(rect, rect_grad, rect_hyst, hthr, lthr);
+    uint32_t hough_ref[2][HOUGH_PEAKS];
+    HoughPeaksRef(host_edge, grad_ref, hough_ref[0]);
+    HoughPeaksRef(rect_edge, rect_grad, hough_ref[1]);
+    for(int f = 0; f < 3; f++) {
+        const int r = f % 2;
+        hls::stream<hlsimproc::ImAxis<24> > im_axis_in_hough, im_axis_out_hough;
+        hls::stream<hlsimproc::ImAxis<32> > im_axis_lines;
+        PackBeats<1>((r == 0) ? frame : rect, im_axis_in_hough);
+        canny_edge_detection_hough(im_axis_in_hough, im_axis_out_hough, im_axis_lines, hthr, lthr, width, height);
+        std::vector<uint8_t> hough_edge(MAX_WIDTH * MAX_HEIGHT);
+        UnpackBeats<1>(im_axis_out_hough, hough_edge);
+        if(hough_edge != ((r == 0) ? host_edge : rect_edge) || im_axis_lines.size() != HOUGH_PEAKS) {
+            printf("Hough frame %d edge mismatch\n", f);
+            return 1;
+        }
+        for(int i = 0; i < HOUGH_PEAKS; i++) {
+            hlsimproc::ImAxis<32> line_reader;
+            im_axis_lines >> line_reader;
+            if(line_reader.data != hough_ref[r][i] || line_reader.user != (i == 0) ||
+               line_reader.last != (i == HOUGH_PEAKS - 1)) {
+                printf("Hough frame %d peak %d mismatch\n", f, i);
+                return 1;
+            }
+            if(f < 2) {
+                const int theta_bin = line_reader.data.range(19, 12);
+                const int rho = (int(line_reader.data.range(11, 0)) << HOUGH_RHO_SHIFT) - MAX_WIDTH;
+                printf("Hough frame %d line %d: rho %d, theta %.1f, %d votes\n", f, i, rho,
+                       180.0 * theta_bin / HOUGH_THETA_BINS, int(line_reader.data.range(31, 20)));
+                if(r == 1 && i < 4 && theta_bin != 0 && theta_bin != HOUGH_THETA_BINS / 2) {
+                    printf("Hough rectangle edge %d is not at 0 or 90 degrees\n", i);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // memory-mapped frame buffers: a batch of three frames with line strides wider than the frame,
+    // the edge maps are the same as canny_edge_detection() and the bytes after each line are not written
+    const uint32_t MM_SRC_STRIDE = MAX_WIDTH + 40;
+    const uint32_t MM_DST_STRIDE = MAX_WIDTH + 64;
+    const std::vector<uint32_t>* mm_frames[3] = { &frame, &rect, &patched };
+    const std::vector<uint8_t>* mm_refs[3] = { &host_edge, &rect_edge, &patched_edge };
+    std::vector<uint32_t> mm_src(3 * MM_SRC_STRIDE * MAX_HEIGHT, 0xffffffff);
+    std::vector<uint8_t> mm_dst(3 * MM_DST_STRIDE * MAX_HEIGHT, 0xAA);
+    for(int f = 0; f < 3; f++) {
+        for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+            mm_src[(f*MAX_HEIGHT + i / MAX_WIDTH)*MM_SRC_STRIDE + i % MAX_WIDTH] = (*mm_frames[f])[i];
+        }
+    }
+    uint32_t mm_src_stride = MM_SRC_STRIDE;
+    uint32_t mm_dst_stride = MM_DST_STRIDE;
+    uint32_t mm_num_frames = 3;
+    canny_edge_detection_mm(mm_src.data(), mm_dst.data(), mm_src_stride, mm_dst_stride, mm_num_frames,
+                            hthr, lthr, width, height);
+    for(int f = 0; f < 3; f++) {
+        for(int yi = 0; yi < MAX_HEIGHT; yi++) {
+            for(uint32_t xi = 0; xi < MM_DST_STRIDE; xi++) {
+                const uint8_t pix = mm_dst[(f*MAX_HEIGHT + yi)*MM_DST_STRIDE + xi];
+                if(pix != ((xi < MAX_WIDTH) ? (*mm_refs[f])[xi + yi*MAX_WIDTH] : 0xAA)) {
+                    printf("memory-mapped frame %d mismatch at (%d, %d)\n", f, int(xi), yi);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // vertical stripes: the same edge map as canny_edge_detection() and as the host engine for a frame
+    // wider than MAX_WIDTH (lenna mirrored side by side, the last stripe narrower than STRIPE_WIDTH)
+    const uint32_t WIDE_WIDTH = 2 * MAX_WIDTH + 76;
+    const uint32_t WIDE_HEIGHT = 300;
+    std::vector<uint32_t> wide(WIDE_WIDTH * WIDE_HEIGHT);
+    for(uint32_t yi = 0; yi < WIDE_HEIGHT; yi++) {
+        for(uint32_t xi = 0; xi < WIDE_WIDTH; xi++) {
+            const uint32_t mx = xi % (2 * MAX_WIDTH);
+            wide[xi + yi*WIDE_WIDTH] = frame[((mx < MAX_WIDTH) ? mx : 2 * MAX_WIDTH - 1 - mx) + yi*MAX_WIDTH];
+        }
+    }
+    std::vector<uint8_t> wide_ref(WIDE_WIDTH * WIDE_HEIGHT);
+    host_engine.Process(wide.data(), wide_ref.data(), WIDE_WIDTH, WIDE_HEIGHT, hthr, lthr);
+    const std::vector<uint32_t>* stripe_frames[3] = { &frame, &rect, &wide };
+    const std::vector<uint8_t>* stripe_refs[3] = { &host_edge, &rect_edge, &wide_ref };
+    for(int f = 0; f < 3; f++) {
+        uint32_t stripe_width = (f < 2) ? MAX_WIDTH : WIDE_WIDTH;
+        uint32_t stripe_height = (f < 2) ? MAX_HEIGHT : WIDE_HEIGHT;
+        std::vector<uint8_t> stripe_edge(stripe_width * stripe_height);
+        canny_edge_detection_stripes(stripe_frames[f]->data(), stripe_edge.data(), stripe_width, stripe_width,
+                                     hthr, lthr, stripe_width, stripe_height);
+        for(uint32_t i = 0; i < stripe_width * stripe_height; i++) {
+            if(stripe_edge[i] != (*stripe_refs[f])[i]) {
+                printf("stripe frame %d (%d x %d) mismatch at (%d, %d)\n", f, int(stripe_width), int(stripe_height),
+                       int(i % stripe_width), int(i / stripe_width));
+                return 1;
+            }
+        }
+    }
+    printf("stripes: %d x %d frame in %d stripes of %d columns, line buffers of %d columns\n",
+           int(WIDE_WIDTH), int(WIDE_HEIGHT), int((WIDE_WIDTH + STRIPE_WIDTH - 1) / STRIPE_WIDTH), STRIPE_WIDTH,
+           STRIPE_WINDOW);
+
+    // pyramid: the full resolution edge map is the same as canny_edge_detection() and the half resolution one
+    // is the stages after GaussianBlur on its decimated output, both from one pass over the input
+    for(int f = 0; f < 2; f++) {
+        const std::vector<uint32_t>& pyr_frame = (f == 0) ? frame : rect;
+        hls::stream<hlsimproc::ImAxis<24> > im_axis_in_pyr, im_axis_out_pyr, im_axis_out_half;
+        PackBeats<1>(pyr_frame, im_axis_in_pyr);
+        canny_edge_detection_pyramid(im_axis_in_pyr, im_axis_out_pyr, im_axis_out_half, hthr, lthr, width, height);
+        std::vector<uint8_t> pyr_edge(MAX_WIDTH * MAX_HEIGHT);
+        UnpackBeats<1>(im_axis_out_pyr, pyr_edge);
+        std::vector<uint8_t> half_ref(MAX_WIDTH / 2 * MAX_HEIGHT / 2);
+        CannyHalfRef(pyr_frame, half_ref, hthr, lthr);
+        if(pyr_edge != ((f == 0) ? host_edge : rect_edge) || !im_axis_in_pyr.empty() ||
+           im_axis_out_half.size() != half_ref.size()) {
+            printf("pyramid frame %d mismatch at full resolution\n", f);
+            return 1;
+        }
+        int num_half_edges = 0;
+        for(int yi = 0; yi < MAX_HEIGHT / 2; yi++) {
+            for(int xi = 0; xi < MAX_WIDTH / 2; xi++) {
+                hlsimproc::ImAxis<24> half_reader;
+                im_axis_out_half >> half_reader;
+                if(half_reader.data != (half_ref[xi + yi*MAX_WIDTH / 2] * 0x010101u) ||
+                   half_reader.user != (xi == 0 && yi == 0) || half_reader.last != (xi == MAX_WIDTH / 2 - 1)) {
+                    printf("pyramid frame %d mismatch at (%d, %d) of half resolution\n", f, xi, yi);
+                    return 1;
+                }
+                num_half_edges += (half_ref[xi + yi*MAX_WIDTH / 2] == 0xFF);
+            }
+        }
+        if(f == 0) {
+            printf("pyramid: %d edge pixels at %d x %d\n", num_half_edges, MAX_WIDTH / 2, MAX_HEIGHT / 2);
+        }
+    }
+
+    // gradient side channel: the edge map is the same as canny_edge_detection(), and beat i of the gradient
+    // stream is the signed Sobel gradient of pixel i of the edge map
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_grad, im_axis_out_grad;
+    hls::stream<hlsimproc::ImAxis<32> > im_axis_grad;
+    PackBeats<1>(frame, im_axis_in_grad);
+    canny_edge_detection_grad(im_axis_in_grad, im_axis_out_grad, im_axis_grad, hthr, lthr, width, height);
+    std::vector<uint8_t> grad_edge(MAX_WIDTH * MAX_HEIGHT);
+    UnpackBeats<1>(im_axis_out_grad, grad_edge);
+    std::vector<int> gx_ref(MAX_WIDTH * MAX_HEIGHT), gy_ref(MAX_WIDTH * MAX_HEIGHT);
+    GradXYRef(frame, gx_ref, gy_ref);
+    if(grad_edge != host_edge || im_axis_grad.size() != MAX_WIDTH * MAX_HEIGHT) {
+        printf("gradient output edge mismatch\n");
+        return 1;
+    }
+    int num_dir_diffs = 0;
+    for(int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) {
+        hlsimproc::ImAxis<32> grad_reader;
+        im_axis_grad >> grad_reader;
+        const int gx = int16_t(grad_reader.data.range(15, 0).to_uint());
+        const int gy = int16_t(grad_reader.data.range(31, 16).to_uint());
+        if(gx != gx_ref[i] || gy != gy_ref[i] || grad_reader.user != (i == 0) ||
+           grad_reader.last != (i % MAX_WIDTH == MAX_WIDTH - 1)) {
+            printf("gradient output mismatch at (%d, %d)\n", i % MAX_WIDTH, i / MAX_WIDTH);
+            return 1;
+        }
+        // the edge pixels carry the direction of their gradient (as the sparse output)
+        if(host_edge[i] == 0xFF) {
+            const double deg = atan2(double(gy), double(gx)) * 180.0 / 3.14159265358979323846;
+            const double fold = (deg < 0) ? deg + 180.0 : deg;
+            const int dir = int((fold + 22.5) / 45.0) % 4;
+            num_dir_diffs += (dir != hlsimproc::GradDirection(grad_ref[i - 2*MAX_WIDTH - 2]));
+        }
+    }
+    printf("gradient output: %d of %d edge pixels with another direction than GradDir\n", num_dir_diffs, sparse_pos);
 
     // convert axis type (hlsimproc::ImAxis -> ap_axiu)
     ap_axiu<24,1,1,1> gen_axis_writer;
@@ -65,6 +1518,42 @@ int main() {
         for(int xi = 0; xi < MAX_WIDTH; xi++) {
             im_axis_out >> im_axis_reader;
 
+            hlsimproc::ImAxis<24> im_axis_reader_th;
+            im_axis_out_th >> im_axis_reader_th;
+            if(im_axis_reader_th.data != im_axis_reader.data ||
+               im_axis_reader_th.user != im_axis_reader.user ||
+               im_axis_reader_th.last != im_axis_reader.last) {
+                printf("threaded dataflow mismatch at (%d, %d)\n", xi, yi);
+                return 1;
+            }
+            hlsimproc::ImAxis<24> im_axis_reader_fused;
+            im_axis_out_fused >> im_axis_reader_fused;
+            if(im_axis_reader_fused.data != im_axis_reader.data ||
+               im_axis_reader_fused.user != im_axis_reader.user ||
+               im_axis_reader_fused.last != im_axis_reader.last) {
+                printf("fused stages mismatch at (%d, %d)\n", xi, yi);
+                return 1;
+            }
+            if(host_edge[xi + yi*MAX_WIDTH] != (im_axis_reader.data & 0xff)) {
+                printf("host engine mismatch at (%d, %d)\n", xi, yi);
+                return 1;
+            }
+            if(ppc_edge[xi + yi*MAX_WIDTH] != (im_axis_reader.data & 0xff) ||
+               ppc2_edge[xi + yi*MAX_WIDTH] != (im_axis_reader.data & 0xff) ||
+               ppc8_edge[xi + yi*MAX_WIDTH] != (im_axis_reader.data & 0xff)) {
+                printf("multi-pixel per clock mismatch at (%d, %d)\n", xi, yi);
+                return 1;
+            }
+            // full hysteresis keeps every edge of the 3x3 comparison
+            // (output is delayed by one line and one pixel as HystThresholdComp)
+            const int hyst_pos = xi + yi*MAX_WIDTH - MAX_WIDTH - 1;
+            const uint8_t hyst_expected = (hyst_pos < 0) ? 0 : hyst_ref[hyst_pos];
+            if(hyst_edge[xi + yi*MAX_WIDTH] != hyst_expected ||
+               ((im_axis_reader.data & 0xff) == 0xFF && hyst_edge[xi + yi*MAX_WIDTH] != 0xFF)) {
+                printf("full hysteresis mismatch at (%d, %d)\n", xi, yi);
+                return 1;
+            }
+
             gen_axis_writer.data = im_axis_reader.data;
             gen_axis_writer.user = im_axis_reader.user;
             gen_axis_writer.last = im_axis_reader.last;
@@ -73,6 +1562,40 @@ int main() {
         }
     }
 
+    // smaller frame (top left of the image) with the frame size registers
+    uint32_t crop_width = CROP_WIDTH;
+    uint32_t crop_height = CROP_HEIGHT;
+    hls::stream<hlsimproc::ImAxis<24> > im_axis_in_crop, im_axis_out_crop;
+    std::vector<uint32_t> crop_frame(CROP_WIDTH * CROP_HEIGHT);
+    for(int yi = 0; yi < CROP_HEIGHT; yi++) {
+        for(int xi = 0; xi < CROP_WIDTH; xi++) {
+            crop_frame[xi + yi*CROP_WIDTH] = frame[xi + yi*MAX_WIDTH];
+
+            im_axis_writer.data = crop_frame[xi + yi*CROP_WIDTH];
+            im_axis_writer.user = (xi == 0 && yi == 0);
+            im_axis_writer.last = (xi == CROP_WIDTH - 1);
+            im_axis_in_crop << im_axis_writer;
+        }
+    }
+    canny_edge_detection(im_axis_in_crop, im_axis_out_crop, hthr, lthr, crop_width, crop_height);
+
+    std::vector<uint8_t> crop_edge(CROP_WIDTH * CROP_HEIGHT);
+    host_engine.Process(crop_frame.data(), crop_edge.data(), CROP_WIDTH, CROP_HEIGHT, hthr, lthr);
+    if(im_axis_out_crop.size() != CROP_WIDTH * CROP_HEIGHT) {
+        printf("%d x %d frame has %d pixels\n", CROP_WIDTH, CROP_HEIGHT, int(im_axis_out_crop.size()));
+        return 1;
+    }
+    for(int yi = 0; yi < CROP_HEIGHT; yi++) {
+        for(int xi = 0; xi < CROP_WIDTH; xi++) {
+            im_axis_out_crop >> im_axis_reader;
+            if(crop_edge[xi + yi*CROP_WIDTH] != (im_axis_reader.data & 0xff) ||
+               im_axis_reader.last != (xi == CROP_WIDTH - 1)) {
+                printf("%d x %d frame mismatch at (%d, %d)\n", CROP_WIDTH, CROP_HEIGHT, xi, yi);
+                return 1;
+            }
+        }
+    }
+
     // AXI4-Stream -> cv::Mat
     AXIvideo2cvMat(gen_axis_out, dst);
 